@@ -0,0 +1,77 @@
+#include "AStar.hpp"
+
+#include <algorithm>
+
+void AStar::use(const BitGrid& walls) {
+	this->walls = &walls;
+	mapHeight = walls.lineCount();
+	mapWidth = walls.lineLength();
+	cells.resize(mapHeight, mapWidth);
+	/* zeroed, so no cell is stamped with a generation yet */
+	generation = 0;
+}
+
+void AStar::setQuery(int startRow, int startCol, int goalRow, int goalCol) {
+	this->startRow = startRow;
+	this->startCol = startCol;
+	this->goalRow = goalRow;
+	this->goalCol = goalCol;
+}
+
+void AStar::run() {
+	const double SQRT2 = std::sqrt(2.0);
+
+	/* on wrap-around the stamps are cleared once so that no cell seems
+	 * reached by an old query */
+	generation += 2;
+	if (generation == 0) {
+		cells.fill(Cell{ INFINITY, 0 });
+		generation = 2;
+	}
+	found = false;
+	pathCost = INFINITY;
+	expansions = 0;
+
+	openList.clear();
+	cells[startRow][startCol] = Cell{ 0, generation };
+	openList.push_back({ heuristic(startRow, startCol), startRow, startCol });
+
+	while (!openList.empty()) {
+		std::pop_heap(openList.begin(), openList.end());
+		Node cur = openList.back();
+		openList.pop_back();
+
+		Cell& curCell = cells[cur.row][cur.col];
+		if (curCell.stamp != generation)
+			continue;
+		curCell.stamp = generation + 1;
+		++expansions;
+
+		double curDist = curCell.distance;
+		if (cur.row == goalRow && cur.col == goalCol) {
+			found = true;
+			pathCost = curDist;
+			return;
+		}
+
+		for (int dir = 0; dir < DIRCOUNT; ++dir) {
+			int r = cur.row + drow[dir];
+			int c = cur.col + dcol[dir];
+			if (!isOpen(r, c))
+				continue;
+			Cell& next = cells[r][c];
+			if (next.stamp == generation + 1)
+				continue;
+			if (!isCardinal(static_cast<direction>(dir)) &&
+				(!isOpen(cur.row + drow[dir], cur.col) || !isOpen(cur.row, cur.col + dcol[dir])))
+				continue;
+
+			double givenCost = curDist + (isCardinal(static_cast<direction>(dir)) ? 1 : SQRT2);
+			if (next.stamp != generation || givenCost < next.distance) {
+				next = Cell{ givenCost, generation };
+				openList.push_back({ givenCost + heuristic(r, c), r, c });
+				std::push_heap(openList.begin(), openList.end());
+			}
+		}
+	}
+}
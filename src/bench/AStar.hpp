@@ -0,0 +1,79 @@
+#ifndef ASTAR_HPP
+#define ASTAR_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+#include "Grid.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Plain octile A* over the wall bitmap, the baseline the benchmark measures
+ * JPS+ against: 8-connected without cutting corners (a diagonal step needs
+ * both cells beside it open), the same octile heuristic and the same
+ * binary-heap open list with lazy deletion as Runtime. Like Runtime, it
+ * stamps the cells a query reaches instead of clearing the map, so that a
+ * query costs what it expands.
+ */
+class AStar {
+public:
+	/* `walls` has to stay alive while it is in use */
+	void use(const BitGrid& walls);
+	void setQuery(int startRow, int startCol, int goalRow, int goalCol);
+	void run();
+
+	bool pathFound() const { return found; }
+	double getPathCost() const { return pathCost; }
+	long getExpansions() const { return expansions; }
+
+private:
+	struct Node {
+		double sortCost;
+		int row, col;
+
+		bool operator<(const Node& o) const { return o.sortCost < sortCost; }
+	};
+
+	/* valid where stamp is the current generation, which is always even;
+	 * stamp is one more once the cell was expanded */
+	struct Cell {
+		double distance;
+		std::uint32_t stamp;
+	};
+
+	inline bool isOpen(const int& r, const int& c) const;
+	inline double heuristic(const int& row, const int& col) const;
+
+private:
+	const BitGrid* walls = nullptr;
+	int mapWidth = 0;
+	int mapHeight = 0;
+
+	int startRow = 0;
+	int startCol = 0;
+	int goalRow = 0;
+	int goalCol = 0;
+
+	bool found = false;
+	double pathCost = 0;
+	long expansions = 0;
+
+	Grid<Cell> cells;
+	std::uint32_t generation = 0;
+	/* kept from query to query so that its storage is reused */
+	std::vector<Node> openList;
+};
+
+bool AStar::isOpen(const int& r, const int& c) const {
+	return 0 <= r && r < mapHeight && 0 <= c && c < mapWidth && !walls->get(r, c);
+}
+
+double AStar::heuristic(const int& row, const int& col) const {
+	int dr = std::abs(row - goalRow);
+	int dc = std::abs(col - goalCol);
+	return std::max(dr, dc) + std::min(dr, dc) * (std::sqrt(2.0) - 1);
+}
+
+#endif /* ASTAR_HPP */
@@ -0,0 +1,49 @@
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include "Scanner.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/*
+ * MovingAI scenario (.scen) files: a "version 1" line followed by one query
+ * per line, "bucket map width height startX startY goalX goalY optimal",
+ * x being the column and y the row.
+ */
+struct ScenarioQuery {
+	int startRow, startCol;
+	int goalRow, goalCol;
+	double optimal;
+};
+
+inline bool readScenario(Scanner& in, std::vector<ScenarioQuery>& queries) {
+	std::string token;
+	if (!in.readToken(token) || token != "version" || !in.readToken(token)) {
+		std::fprintf(stderr, "malformed scenario header\n");
+		return false;
+	}
+
+	int bucket, width, height;
+	std::string map, optimal;
+	while (in.readInt(bucket)) {
+		ScenarioQuery q;
+		if (!in.readToken(map) || !in.readInt(width) || !in.readInt(height) ||
+			!in.readInt(q.startCol) || !in.readInt(q.startRow) ||
+			!in.readInt(q.goalCol) || !in.readInt(q.goalRow) || !in.readToken(optimal)) {
+			std::fprintf(stderr, "malformed scenario line %zu\n", queries.size() + 2);
+			return false;
+		}
+		q.optimal = std::strtod(optimal.c_str(), nullptr);
+		queries.push_back(q);
+	}
+	if (in.skipSpace() != EOF) {
+		std::fprintf(stderr, "malformed scenario line %zu\n", queries.size() + 2);
+		return false;
+	}
+	return true;
+}
+
+#endif /* SCENARIO_HPP */
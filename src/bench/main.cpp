@@ -0,0 +1,559 @@
+#include "AStar.hpp"
+#include "GoalBounds.hpp"
+#include "Hierarchy.hpp"
+#include "Landmarks.hpp"
+#include "Overlay.hpp"
+#include "Preprocessor.hpp"
+#include "Runtime.hpp"
+#include "Scanner.hpp"
+#include "Scenario.hpp"
+#include "SlicedSearch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+/*
+ * Runs every query of a MovingAI scenario through the JPS+ runtime and the
+ * A* baseline, checks the costs against the scenario's optimal lengths and
+ * reports time and expansions per query. The runtime always runs with each
+ * open list, with double and fixed costs (-f), on a tiled table and from
+ * both ends, which is also set against one direction on the longest
+ * quarter of the queries. Further rows:
+ *   -g  with goal bounds
+ *   -L  with landmark bounds (-K of them) on top of octile distance
+ *   -H  over a hierarchy (-k cluster size) at several suboptimality bounds,
+ *       also on the longest quarter
+ *   -O  around cells blocked in an overlay, next to a table preprocessed
+ *       with them as walls
+ *   -F  through one flow field against a search per agent, for every start
+ *       sent to a single goal
+ *   -S  in time slices of so many ns, as a game loop would run them
+ * -n leaves out the A* baseline, -t sets the preprocessing threads.
+ */
+struct Measurement {
+	double ns = 0;
+	long expansions = 0;
+	int mismatches = 0;
+};
+
+/* costs may be off by a relative `tolerance`, fixed costs round sqrt(2).
+ * The first query runs once untimed beforehand, so that state sized on
+ * first use after switching modes is not counted against that mode */
+template<typename Search>
+Measurement measure(Search& search, const std::vector<ScenarioQuery>& queries, const char* name,
+	double tolerance = 1e-4) {
+	Measurement m;
+	if (!queries.empty()) {
+		search.setQuery(queries[0].startRow, queries[0].startCol, queries[0].goalRow, queries[0].goalCol);
+		search.run();
+	}
+	auto start = std::chrono::steady_clock::now();
+	for (const ScenarioQuery& q : queries) {
+		search.setQuery(q.startRow, q.startCol, q.goalRow, q.goalCol);
+		search.run();
+		m.expansions += search.getExpansions();
+
+		/* scenario lengths are printed with 8 decimals */
+		if (!search.pathFound() || std::fabs(search.getPathCost() - q.optimal) > tolerance * std::max(1.0, q.optimal)) {
+			if (m.mismatches++ < 5)
+				fprintf(stderr, "%s: (%d, %d) -> (%d, %d) cost %.8f, expected %.8f\n", name,
+					q.startCol, q.startRow, q.goalCol, q.goalRow, search.getPathCost(), q.optimal);
+		}
+	}
+	m.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	return m;
+}
+
+/* length of the last path found, negative unless it is a chain of open,
+ * adjacent cells from the start to the goal of `q` */
+double pathLength(Runtime& runtime, const BitGrid& walls, const ScenarioQuery& q) {
+	const std::vector<Runtime::PathCell>& path = runtime.cellPath();
+	bool ok = !path.empty() && path.front().row == q.startRow && path.front().col == q.startCol &&
+		path.back().row == q.goalRow && path.back().col == q.goalCol;
+	double length = 0;
+	for (std::size_t i = 0; ok && i < path.size(); ++i) {
+		ok = !walls.get(path[i].row, path[i].col);
+		if (i > 0) {
+			int dr = std::abs(path[i].row - path[i - 1].row);
+			int dc = std::abs(path[i].col - path[i - 1].col);
+			ok = ok && std::max(dr, dc) == 1;
+			length += dr && dc ? std::sqrt(2.0) : 1;
+		}
+	}
+	return ok ? length : -1;
+}
+
+/* every JPS+ path has to be as long as the reported cost */
+int checkPaths(Runtime& runtime, const BitGrid& walls, const std::vector<ScenarioQuery>& queries) {
+	int bad = 0;
+	for (const ScenarioQuery& q : queries) {
+		runtime.setQuery(q.startRow, q.startCol, q.goalRow, q.goalCol);
+		runtime.run();
+		double length = pathLength(runtime, walls, q);
+		if (length < 0 || std::fabs(length - runtime.getPathCost()) > 1e-6 * std::max(1.0, length)) {
+			if (bad++ < 5)
+				fprintf(stderr, "path: (%d, %d) -> (%d, %d) is not a valid path of cost %.8f\n",
+					q.startCol, q.startRow, q.goalCol, q.goalRow, runtime.getPathCost());
+		}
+	}
+	return bad;
+}
+
+/* fixed costs: the largest relative error of the reported costs, and how
+ * many of the paths are longer than optimal once measured with sqrt(2),
+ * by at most `excess` */
+struct Accuracy {
+	double costError = 0;
+	int longer = 0;
+	double excess = 0;
+	int invalid = 0;
+	/* nodes of a hierarchy expanded, in all */
+	long abstractExpansions = 0;
+};
+
+Accuracy checkAccuracy(Runtime& runtime, const BitGrid& walls, const std::vector<ScenarioQuery>& queries) {
+	Accuracy a;
+	for (const ScenarioQuery& q : queries) {
+		runtime.setQuery(q.startRow, q.startCol, q.goalRow, q.goalCol);
+		runtime.run();
+		a.abstractExpansions += runtime.getAbstractExpansions();
+		double length = pathLength(runtime, walls, q);
+		if (length < 0) {
+			++a.invalid;
+			continue;
+		}
+		double scale = std::max(1.0, q.optimal);
+		a.costError = std::max(a.costError, std::fabs(runtime.getPathCost() - q.optimal) / scale);
+		if (length - q.optimal > 1e-6 * scale) {
+			++a.longer;
+			a.excess = std::max(a.excess, (length - q.optimal) / scale);
+		}
+	}
+	return a;
+}
+
+int main(int argc, char* argv[]) {
+	Preprocessor preprocessor;
+	bool baseline = true;
+	bool bounding = false;
+	int cardinal = 1000, diagonal = 1414;
+	int clusterSize = 0;
+	int landmarkCount = 0;
+	int overlayCount = 0;
+	bool flow = false;
+	long sliceNs = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:ngf:Hk:LK:O:FS:")) != -1) {
+		switch (opt) {
+			case 't':
+				preprocessor.setThreadCount(std::atoi(optarg));
+				break;
+			case 'n':
+				baseline = false;
+				break;
+			case 'g':
+				bounding = true;
+				break;
+			case 'f':
+				if (sscanf(optarg, "%d:%d", &cardinal, &diagonal) != 2) {
+					fprintf(stderr, "bad fixed costs %s, expected cardinal:diagonal\n", optarg);
+					return 1;
+				}
+				break;
+			case 'H':
+				clusterSize = std::max(clusterSize, Hierarchy::DEFAULT_CLUSTER);
+				break;
+			case 'k':
+				clusterSize = std::atoi(optarg);
+				break;
+			case 'L':
+				landmarkCount = std::max(landmarkCount, Landmarks::DEFAULT_COUNT);
+				break;
+			case 'K':
+				landmarkCount = std::atoi(optarg);
+				break;
+			case 'O':
+				overlayCount = std::atoi(optarg);
+				break;
+			case 'F':
+				flow = true;
+				break;
+			case 'S':
+				sliceNs = std::atol(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-t threads] [-n] [-g] [-f cardinal:diagonal] [-H] [-k cluster] [-L] [-K landmarks] [-O blocked] [-F] [-S slice ns] map scen\n", argv[0]);
+				return 1;
+		}
+	}
+	if (argc - optind != 2) {
+		fprintf(stderr, "usage: %s [-t threads] [-n] [-g] [-f cardinal:diagonal] [-H] [-k cluster] [-L] [-K landmarks] [-O blocked] [-F] [-S slice ns] map scen\n", argv[0]);
+		return 1;
+	}
+
+	Scanner mapFile, scenFile;
+	std::vector<ScenarioQuery> queries;
+	if (!mapFile.open(argv[optind]) || !preprocessor.read(mapFile) ||
+		!scenFile.open(argv[optind + 1]) || !readScenario(scenFile, queries))
+		return 1;
+	for (const ScenarioQuery& q : queries)
+		if (std::min({ q.startRow, q.startCol, q.goalRow, q.goalCol }) < 0 ||
+			std::max(q.startRow, q.goalRow) >= preprocessor.height() ||
+			std::max(q.startCol, q.goalCol) >= preprocessor.width()) {
+			fprintf(stderr, "scenario does not fit a %dx%d map\n", preprocessor.width(), preprocessor.height());
+			return 1;
+		}
+
+	preprocessor.preprocess();
+
+	Runtime runtime;
+	runtime.use(preprocessor);
+	runtime.setTrace(false);
+	if (!runtime.setFixedCosts(cardinal, diagonal))
+		return 1;
+	runtime.setFixedCosts(0, 0);
+
+	printf("map: %dx%d, %zu queries\n", preprocessor.width(), preprocessor.height(), queries.size());
+	printf("preprocessing: %.3f ms, %d threads\n", preprocessor.getPreprocessingTime(), preprocessor.getThreadCount());
+	if (queries.empty())
+		return 0;
+
+	/* -g: goal bounds too, timed on their own */
+	GoalBounds bounds;
+	if (bounding) {
+		if (!bounds.build(preprocessor.walls(), preprocessor.getThreadCount()))
+			return 1;
+		printf("goal bounding: %.3f ms, %d threads\n", bounds.getBuildTime(), preprocessor.getThreadCount());
+	}
+	/* -L or -K: landmarks too, timed on their own */
+	Landmarks landmarks;
+	if (landmarkCount) {
+		if (!landmarks.build(preprocessor.walls(), landmarkCount))
+			return 1;
+		printf("landmarks: %.3f ms, %d landmarks, %.1f MB each\n", landmarks.getBuildTime(),
+			landmarks.count(), landmarks.bytesPerLandmark() / 1e6);
+	}
+	/* -H or -k: a hierarchy too, timed on its own */
+	Hierarchy hierarchy;
+	if (clusterSize) {
+		if (!hierarchy.build(preprocessor.walls(), clusterSize, preprocessor.getThreadCount()))
+			return 1;
+		printf("hierarchy: %.3f ms, %d threads, %dx%d clusters, %zu nodes, %zu edges\n", hierarchy.getBuildTime(),
+			preprocessor.getThreadCount(), clusterSize, clusterSize, hierarchy.nodeCount(), hierarchy.edgeCount());
+	}
+
+	const double n = queries.size();
+	printf("%-14s %14s %18s %12s\n", "search", "ns/query", "expansions/query", "mismatches");
+	const struct {
+		Runtime::openListType type;
+		const char* name;
+	} openLists[] = {
+		{ Runtime::OPENLIST_BINARY, "JPS+ binary" },
+		{ Runtime::OPENLIST_INDEXED, "JPS+ indexed" },
+		{ Runtime::OPENLIST_BUCKET, "JPS+ bucket" }
+	};
+	int mismatches = 0;
+	double fastest = INFINITY;
+	Measurement octile;
+	for (const auto& list : openLists) {
+		runtime.setOpenList(list.type);
+		Measurement jps = measure(runtime, queries, list.name);
+		if (list.type == Runtime::OPENLIST_BINARY)
+			octile = jps;
+		printf("%-14s %14.0f %18.1f %12d\n", list.name, jps.ns / n, jps.expansions / n, jps.mismatches);
+		mismatches += jps.mismatches;
+		fastest = std::min(fastest, jps.ns);
+	}
+
+	/* the same with fixed costs, whose costs are only as close to the
+	 * optimal ones as diagonal / cardinal is to sqrt(2) */
+	const double ratioError = std::fabs(static_cast<double>(diagonal) / cardinal - std::sqrt(2.0)) / std::sqrt(2.0);
+	const char* fixedNames[] = { "fixed binary", "fixed indexed", "fixed bucket" };
+	runtime.setFixedCosts(cardinal, diagonal);
+	for (int i = 0; i < 3; ++i) {
+		runtime.setOpenList(openLists[i].type);
+		Measurement jps = measure(runtime, queries, fixedNames[i], ratioError + 1e-4);
+		printf("%-14s %14.0f %18.1f %12d\n", fixedNames[i], jps.ns / n, jps.expansions / n, jps.mismatches);
+		mismatches += jps.mismatches;
+		fastest = std::min(fastest, jps.ns);
+	}
+	Accuracy accuracy = checkAccuracy(runtime, preprocessor.walls(), queries);
+	printf("fixed %d:%d: cost error %.2e, %d paths longer than optimal by up to %.2e, %d invalid\n",
+		cardinal, diagonal, accuracy.costError, accuracy.longer, accuracy.excess, accuracy.invalid);
+	mismatches += accuracy.invalid;
+	runtime.setFixedCosts(0, 0);
+	runtime.setOpenList(Runtime::OPENLIST_BINARY);
+
+	/* distances and search state in 8x8 blocks, on a runtime of its own */
+	{
+		Runtime tiled;
+		tiled.use(preprocessor);
+		tiled.setTrace(false);
+		tiled.tile();
+		Measurement jps = measure(tiled, queries, "JPS+ tiled");
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ tiled", jps.ns / n, jps.expansions / n, jps.mismatches);
+		mismatches += jps.mismatches;
+		fastest = std::min(fastest, jps.ns);
+	}
+
+	runtime.setBidirectional(true);
+	{
+		Measurement jps = measure(runtime, queries, "JPS+ bidir");
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ bidir", jps.ns / n, jps.expansions / n, jps.mismatches);
+		mismatches += jps.mismatches;
+		fastest = std::min(fastest, jps.ns);
+		int badPaths = checkPaths(runtime, preprocessor.walls(), queries);
+		printf("bidir paths: %d invalid\n", badPaths);
+		mismatches += badPaths;
+	}
+	std::vector<ScenarioQuery> longest(queries);
+	std::sort(longest.begin(), longest.end(),
+		[](const ScenarioQuery& a, const ScenarioQuery& b) { return a.optimal > b.optimal; });
+	longest.resize(std::max<std::size_t>(1, longest.size() / 4));
+	const struct {
+		bool bidirectional;
+		const char* name;
+	} directions[] = { { false, "long binary" }, { true, "long bidir" } };
+	for (const auto& direction : directions) {
+		runtime.setBidirectional(direction.bidirectional);
+		Measurement jps = measure(runtime, longest, direction.name);
+		printf("%-14s %14.0f %18.1f %12d\n", direction.name, jps.ns / longest.size(),
+			static_cast<double>(jps.expansions) / longest.size(), jps.mismatches);
+		mismatches += jps.mismatches;
+	}
+	runtime.setBidirectional(false);
+
+	if (bounding) {
+		runtime.setGoalBounds(&bounds);
+		Measurement jps = measure(runtime, queries, "JPS+ bounded");
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ bounded", jps.ns / n, jps.expansions / n, jps.mismatches);
+		mismatches += jps.mismatches;
+		fastest = std::min(fastest, jps.ns);
+	}
+
+	int badPaths = checkPaths(runtime, preprocessor.walls(), queries);
+	printf("paths: %d invalid\n", badPaths);
+	mismatches += badPaths;
+
+	/* landmarks alone, against octile distance with the same open list */
+	if (landmarkCount) {
+		runtime.setGoalBounds(nullptr);
+		runtime.setLandmarks(&landmarks);
+		Measurement jps = measure(runtime, queries, "JPS+ ALT");
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ ALT", jps.ns / n, jps.expansions / n, jps.mismatches);
+		runtime.setFixedCosts(cardinal, diagonal);
+		Measurement fixed = measure(runtime, queries, "fixed ALT", ratioError + 1e-4);
+		printf("%-14s %14.0f %18.1f %12d\n", "fixed ALT", fixed.ns / n, fixed.expansions / n, fixed.mismatches);
+		runtime.setFixedCosts(0, 0);
+		Measurement far = measure(runtime, longest, "long ALT");
+		printf("%-14s %14.0f %18.1f %12d\n", "long ALT", far.ns / longest.size(),
+			static_cast<double>(far.expansions) / longest.size(), far.mismatches);
+		int badPaths = checkPaths(runtime, preprocessor.walls(), queries);
+		printf("ALT: %.1f%% fewer expansions than octile, %.1f MB for %d landmarks, paths: %d invalid\n",
+			100.0 * (octile.expansions - jps.expansions) / std::max(1L, octile.expansions),
+			landmarks.count() * landmarks.bytesPerLandmark() / 1e6, landmarks.count(), badPaths);
+		mismatches += jps.mismatches + fixed.mismatches + far.mismatches + badPaths;
+		fastest = std::min(fastest, jps.ns);
+		runtime.setLandmarks(nullptr);
+	}
+
+	/* refined paths may be longer than optimal by their bound, not more */
+	if (clusterSize) {
+		runtime.setGoalBounds(nullptr);
+		const struct {
+			double suboptimality;
+			const char* name;
+			const char* longName;
+		} refinements[] = {
+			{ INFINITY, "HPA* w=inf", "long w=inf" },
+			{ 1.1, "HPA* w=1.1", "long w=1.1" }
+		};
+		for (const auto& refinement : refinements) {
+			runtime.setHierarchy(&hierarchy, refinement.suboptimality);
+			double tolerance = refinement.suboptimality - 1 + 1e-4;
+			Measurement jps = measure(runtime, queries, refinement.name, tolerance);
+			printf("%-14s %14.0f %18.1f %12d\n", refinement.name, jps.ns / n, jps.expansions / n, jps.mismatches);
+			Measurement far = measure(runtime, longest, refinement.longName, tolerance);
+			printf("%-14s %14.0f %18.1f %12d\n", refinement.longName, far.ns / longest.size(),
+				static_cast<double>(far.expansions) / longest.size(), far.mismatches);
+			Accuracy accuracy = checkAccuracy(runtime, preprocessor.walls(), queries);
+			printf("%s: %.1f abstract nodes/query, %d paths longer than optimal by up to %.2e, %d invalid\n",
+				refinement.name, accuracy.abstractExpansions / n, accuracy.longer, accuracy.excess, accuracy.invalid);
+			mismatches += jps.mismatches + far.mismatches + accuracy.invalid;
+		}
+		runtime.setHierarchy(nullptr);
+	}
+
+	/* -O: random open cells blocked, answered from the table through the
+	 * overlay and from a table patched with them as walls, which have to
+	 * agree; only queries with a path left count */
+	if (overlayCount) {
+		Overlay overlay(preprocessor.height(), preprocessor.width());
+		std::vector<Preprocessor::Cell> cells;
+		std::mt19937 random(1);
+		std::uniform_int_distribution<int> row(0, preprocessor.height() - 1), col(0, preprocessor.width() - 1);
+		for (long tries = 0; static_cast<int>(cells.size()) < overlayCount && tries < 100L * overlayCount; ++tries) {
+			int r = row(random), c = col(random);
+			if (!preprocessor.walls().get(r, c) && overlay.block(r, c))
+				cells.push_back({ r, c });
+		}
+		auto start = std::chrono::steady_clock::now();
+		for (const Preprocessor::Cell& cell : cells)
+			overlay.unblock(cell.row, cell.col);
+		for (const Preprocessor::Cell& cell : cells)
+			overlay.block(cell.row, cell.col);
+		double updateNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		Preprocessor edited(preprocessor);
+		edited.toggleCells(cells);
+		Runtime patched;
+		patched.use(edited);
+		patched.setTrace(false);
+		std::vector<ScenarioQuery> connected;
+		for (ScenarioQuery q : queries) {
+			if (overlay.blocked(q.startRow, q.startCol) || overlay.blocked(q.goalRow, q.goalCol))
+				continue;
+			patched.setQuery(q.startRow, q.startCol, q.goalRow, q.goalCol);
+			patched.run();
+			if (!patched.pathFound())
+				continue;
+			q.optimal = patched.getPathCost();
+			connected.push_back(q);
+		}
+
+		if (!connected.empty()) {
+			const double m = connected.size();
+			runtime.setOverlay(&overlay);
+			Measurement jps = measure(runtime, connected, "JPS+ overlay");
+			printf("%-14s %14.0f %18.1f %12d\n", "JPS+ overlay", jps.ns / m, jps.expansions / m, jps.mismatches);
+			Measurement base = measure(patched, connected, "JPS+ patched");
+			printf("%-14s %14.0f %18.1f %12d\n", "JPS+ patched", base.ns / m, base.expansions / m, base.mismatches);
+			int badPaths = checkPaths(runtime, edited.walls(), connected);
+			printf("overlay: %zu cells blocked, %.1f ns/update, %.3f ms to patch the table, %zu queries left, paths: %d invalid\n",
+				cells.size(), updateNs / std::max<std::size_t>(1, 2 * cells.size()), edited.getUpdateTime(),
+				connected.size(), badPaths);
+			mismatches += jps.mismatches + base.mismatches + badPaths;
+			runtime.setOverlay(nullptr);
+		}
+	}
+
+	/* -F: every start sent to the goal of the longest query, by a search
+	 * each and by walking a single flow field */
+	if (flow) {
+		runtime.setGoalBounds(nullptr);
+		const ScenarioQuery& far = longest.front();
+		std::vector<ScenarioQuery> agents;
+		for (const ScenarioQuery& q : queries)
+			agents.push_back({ q.startRow, q.startCol, far.goalRow, far.goalCol, 0 });
+		long searchExpansions = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (ScenarioQuery& a : agents) {
+			runtime.setQuery(a.startRow, a.startCol, a.goalRow, a.goalCol);
+			runtime.run();
+			a.optimal = runtime.pathFound() ? runtime.getPathCost() : -1;
+			searchExpansions += runtime.getExpansions();
+		}
+		double searchNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		FlowField field;
+		runtime.setQuery(far.startRow, far.startCol, far.goalRow, far.goalCol);
+		runtime.buildFlowField(field);
+		long fieldExpansions = runtime.getExpansions();
+		std::vector<FlowField::Cell> path;
+		int wrong = 0;
+		start = std::chrono::steady_clock::now();
+		for (const ScenarioQuery& a : agents) {
+			double cost;
+			bool reached = field.walk(a.startRow, a.startCol, path, cost);
+			if (reached != (a.optimal >= 0) || (reached && std::fabs(cost - a.optimal) > 1e-6 * std::max(1.0, cost))) {
+				if (wrong++ < 5)
+					fprintf(stderr, "flow field: (%d, %d) -> (%d, %d) cost %.8f, expected %.8f\n",
+						a.startCol, a.startRow, a.goalCol, a.goalRow, reached ? cost : -1, a.optimal);
+			}
+		}
+		double walkNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		const double fieldNs = field.getBuildTime() * 1e6;
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ one goal", searchNs / n, searchExpansions / n, 0);
+		printf("%-14s %14.0f %18.1f %12d\n", "flow field", (fieldNs + walkNs) / n, fieldExpansions / n, wrong);
+		double perAgent = (searchNs - walkNs) / n;
+		printf("flow field: %.3f ms to build, %.1f KB, %.0f ns/agent to walk, worth it from %.0f agents\n",
+			field.getBuildTime(), field.bytes() / 1e3, walkNs / n, perAgent > 0 ? std::ceil(fieldNs / perAgent) : INFINITY);
+		mismatches += wrong;
+	}
+
+	/* -S: every query resumed in slices of so many ns until it is done;
+	 * only the slices are timed, and the partial path after each has to
+	 * lead from the start over open cells. One SlicedSearch serves them
+	 * all, warmed up first so that its storage has grown */
+	if (sliceNs > 0) {
+		auto partialValid = [&](const std::vector<SlicedSearch::Cell>& path, const ScenarioQuery& q) {
+			if (path.empty() || path.front().row != q.startRow || path.front().col != q.startCol)
+				return false;
+			for (std::size_t i = 1; i < path.size(); ++i) {
+				int dr = path[i].row - path[i - 1].row, dc = path[i].col - path[i - 1].col;
+				if (dr && dc && std::abs(dr) != std::abs(dc))
+					return false;
+				for (SlicedSearch::Cell cell = path[i - 1]; cell.row != path[i].row || cell.col != path[i].col;) {
+					cell.row += (dr > 0) - (dr < 0);
+					cell.col += (dc > 0) - (dc < 0);
+					if (preprocessor.walls().get(cell.row, cell.col))
+						return false;
+				}
+			}
+			return true;
+		};
+		SlicedSearch search;
+		runtime.start(search, queries[0].startRow, queries[0].startCol, queries[0].goalRow, queries[0].goalCol);
+		while (!runtime.resume(search, 0));
+		std::vector<double> slices;
+		Measurement m;
+		int badPartial = 0;
+		std::size_t peakBytes = 0;
+		for (const ScenarioQuery& q : queries) {
+			runtime.start(search, q.startRow, q.startCol, q.goalRow, q.goalCol);
+			bool done;
+			do {
+				auto start = std::chrono::steady_clock::now();
+				done = runtime.resume(search, 0, sliceNs);
+				slices.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+				m.ns += slices.back();
+				if (!partialValid(search.partialPath(), q))
+					++badPartial;
+			} while (!done);
+			m.expansions += search.getExpansions();
+			peakBytes = std::max(peakBytes, search.bytes());
+			if (!search.pathFound() || std::fabs(search.getPathCost() - q.optimal) > 1e-4 * std::max(1.0, q.optimal)) {
+				if (m.mismatches++ < 5)
+					fprintf(stderr, "JPS+ sliced: (%d, %d) -> (%d, %d) cost %.8f, expected %.8f\n",
+						q.startCol, q.startRow, q.goalCol, q.goalRow, search.getPathCost(), q.optimal);
+			}
+		}
+		std::sort(slices.begin(), slices.end());
+		printf("%-14s %14.0f %18.1f %12d\n", "JPS+ sliced", m.ns / n, m.expansions / n, m.mismatches);
+		printf("sliced %ld ns: %.1f slices/query, p99 slice %.0f ns, longest %.0f ns, partial paths: %d invalid\n",
+			sliceNs, slices.size() / n, slices[static_cast<std::size_t>(0.99 * (slices.size() - 1))], slices.back(),
+			badPartial);
+		printf("sliced state: %.1f KB per search at most, %.1f KB for the cells of the whole map\n",
+			peakBytes / 1e3, static_cast<double>(runtime.height()) * runtime.width() * sizeof(CellState<double>) / 1e3);
+		mismatches += m.mismatches + badPartial;
+	}
+
+	if (baseline) {
+		AStar astar;
+		astar.use(preprocessor.walls());
+		Measurement base = measure(astar, queries, "A*");
+		printf("%-14s %14.0f %18.1f %12d\n", "A*", base.ns / n, base.expansions / n, base.mismatches);
+		printf("speedup: %.2fx (fastest JPS+)\n", base.ns / fastest);
+		mismatches += base.mismatches;
+	}
+
+	return mismatches ? 1 : 0;
+}
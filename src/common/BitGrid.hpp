@@ -0,0 +1,123 @@
+#ifndef BITGRID_HPP
+#define BITGRID_HPP
+
+#include "Grid.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+/*
+ * Bit-packed 2D boolean grid: every line (a row, or a column in a transposed
+ * copy) is stored as 64 cells per word, bit i of word k holding cell 64k + i.
+ * Bits past the end of a line are padding and keep the value given on
+ * construction, so e.g. a wall bitboard padded with ones makes scans stop at
+ * the map border exactly as they do at a wall.
+ */
+class BitGrid {
+public:
+	using word = std::uint64_t;
+	static constexpr int WORDBITS = 64;
+
+	BitGrid() = default;
+	BitGrid(int lines, int length, bool padding = false);
+
+	void resize(int lines, int length, bool padding = false);
+
+	inline bool get(const int& line, const int& pos) const;
+	inline void set(const int& line, const int& pos, const bool& value);
+
+	word* line(const int& l) { return bits[l]; }
+	const word* line(const int& l) const { return bits[l]; }
+
+	int lineCount() const { return lines; }
+	int lineLength() const { return length; }
+	int wordsPerLine() const { return bits.width(); }
+
+	BitGrid transposed() const;
+
+private:
+	void applyPadding();
+	static void transpose64(word block[WORDBITS]);
+
+private:
+	Grid<word> bits;
+	int lines = 0;
+	int length = 0;
+	bool padding = false;
+};
+
+bool BitGrid::get(const int& line, const int& pos) const {
+	assert(0 <= pos && pos < length);
+	return bits[line][pos / WORDBITS] >> (pos % WORDBITS) & 1;
+}
+
+void BitGrid::set(const int& line, const int& pos, const bool& value) {
+	assert(0 <= pos && pos < length);
+	word mask = word(1) << (pos % WORDBITS);
+	word& w = bits[line][pos / WORDBITS];
+	w = value ? (w | mask) : (w & ~mask);
+}
+
+inline BitGrid::BitGrid(int lines, int length, bool padding) {
+	resize(lines, length, padding);
+}
+
+inline void BitGrid::resize(int lines, int length, bool padding) {
+	this->lines = lines;
+	this->length = length;
+	this->padding = padding;
+	bits.resize(lines, (length + WORDBITS - 1) / WORDBITS);
+	applyPadding();
+}
+
+inline BitGrid BitGrid::transposed() const {
+	BitGrid result(length, lines, padding);
+	int srcWords = wordsPerLine();
+	int dstWords = result.wordsPerLine();
+	word block[WORDBITS];
+
+	/* transpose one 64x64 block at a time: source lines [64bl, 64bl + 64) of
+	 * word bw become destination lines [64bw, 64bw + 64) of word bl */
+	for (int bl = 0; bl < dstWords; ++bl)
+		for (int bw = 0; bw < srcWords; ++bw) {
+			for (int i = 0; i < WORDBITS; ++i) {
+				int l = bl * WORDBITS + i;
+				block[i] = l < lines ? bits[l][bw] : 0;
+			}
+			transpose64(block);
+			for (int i = 0; i < WORDBITS; ++i) {
+				int l = bw * WORDBITS + i;
+				if (l < length)
+					result.bits[l][bl] = block[i];
+			}
+		}
+
+	result.applyPadding();
+	return result;
+}
+
+inline void BitGrid::applyPadding() {
+	int tail = length % WORDBITS;
+	if (!tail || bits.width() == 0)
+		return;
+
+	word mask = ~word(0) << tail;
+	for (int l = 0; l < lines; ++l) {
+		word& w = bits[l][bits.width() - 1];
+		w = padding ? (w | mask) : (w & ~mask);
+	}
+}
+
+/* In-place transpose of a 64x64 bit matrix, block[i] bit j <-> block[j] bit i
+ * (recursive block swap, Hacker's Delight 7-3). */
+inline void BitGrid::transpose64(word block[WORDBITS]) {
+	word m = 0x00000000FFFFFFFFULL;
+	for (int j = 32; j; j >>= 1, m ^= m << j)
+		for (int k = 0; k < WORDBITS; k = ((k | j) + 1) & ~j) {
+			word t = ((block[k] >> j) ^ block[k | j]) & m;
+			block[k] ^= t << j;
+			block[k | j] ^= t;
+		}
+}
+
+#endif /* BITGRID_HPP */
@@ -0,0 +1,67 @@
+#ifndef DIRECTION_HPP
+#define DIRECTION_HPP
+
+#include <string>
+#include <vector>
+
+/*
+ * The direction table shared by preprocessing and search. Distance cells
+ * are indexed in enum order; NONE marks the start node of a search.
+ */
+enum direction {
+	NORTH = 0, SOUTH, WEST, EAST,
+	NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST,
+	NONE
+};
+
+constexpr int DIRCOUNT = 8;
+
+/* clockwise from NORTH, the order of the text formats */
+constexpr direction ALLDIRS[DIRCOUNT] = {
+	NORTH, NORTHEAST, EAST, SOUTHEAST,
+	SOUTH, SOUTHWEST, WEST, NORTHWEST
+};
+
+/* row and column step, indexed by direction */
+constexpr int drow[DIRCOUNT] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+constexpr int dcol[DIRCOUNT] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+/* directions a search continues in after moving in a direction; diagonals
+ * list their two cardinal components first */
+inline const std::vector<direction> validDirections[DIRCOUNT + 1] = {
+	{ WEST, NORTHWEST, NORTH, NORTHEAST, EAST }, /* NORTH */
+	{ WEST, SOUTHWEST, SOUTH, SOUTHEAST, EAST }, /* SOUTH */
+	{ NORTH, NORTHWEST, WEST, SOUTHWEST, SOUTH }, /* WEST */
+	{ NORTH, NORTHEAST, EAST, SOUTHEAST, SOUTH }, /* EAST */
+	{ NORTH, WEST, NORTHWEST }, /* NORTHWEST */
+	{ NORTH, EAST, NORTHEAST }, /* NORTHEAST */
+	{ SOUTH, WEST, SOUTHWEST }, /* SOUTHWEST */
+	{ SOUTH, EAST, SOUTHEAST }, /* SOUTHEAST */
+	{ NORTH, SOUTH, WEST, EAST, NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST } /* NONE */
+};
+
+inline bool isCardinal(const direction& dir) {
+	return dir < NORTHWEST;
+}
+
+/* the way back: NORTH and SOUTH, WEST and EAST, NORTHWEST and SOUTHEAST,
+ * NORTHEAST and SOUTHWEST */
+inline direction reverse(const direction& dir) {
+	return static_cast<direction>(isCardinal(dir) ? dir ^ 1 : dir ^ 3);
+}
+
+inline std::string dirToStr(const direction& dir) {
+	switch (dir) {
+		case NORTH: return "N";
+		case SOUTH: return "S";
+		case WEST: return "W";
+		case EAST: return "E";
+		case NORTHWEST: return "NW";
+		case NORTHEAST: return "NE";
+		case SOUTHWEST: return "SW";
+		case SOUTHEAST: return "SE";
+		default: return "UNKNOWN";
+	}
+}
+
+#endif /* DIRECTION_HPP */
@@ -0,0 +1,261 @@
+#ifndef DISTANCETABLE_HPP
+#define DISTANCETABLE_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+#include "Grid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/* jump distances of one cell, indexed by direction */
+using DistanceCell = std::array<int, DIRCOUNT>;
+
+/*
+ * Read access to the jump distances. Every encoding answers
+ * get(r, c, dir) for open cells, so the search can be instantiated over
+ * any of them, and index(r, c), the cell's slot in per-cell search state
+ * laid out like the table.
+ */
+class DenseDistanceTable {
+public:
+	DenseDistanceTable() = default;
+	DenseDistanceTable(GridView<const DistanceCell> cells) : cells(cells) {}
+
+	inline int get(const int& r, const int& c, const int& dir) const {
+		return cells[r][c][dir];
+	}
+	inline std::size_t index(const int& r, const int& c) const {
+		return static_cast<std::size_t>(r) * cells.width() + c;
+	}
+
+	std::size_t bytes() const { return static_cast<std::size_t>(cells.height()) * cells.width() * sizeof(DistanceCell); }
+
+private:
+	GridView<const DistanceCell> cells;
+};
+
+/*
+ * Open cells only, 8 signed bytes each, in row-major order. A cell's slot is
+ * found by rank over the wall bitmap: ranks[w] counts the open cells before
+ * bitmap word w and a popcount covers the rest of the word. Distances that
+ * do not fit in an int8 are stored as ESCAPE and looked up in a sorted side
+ * table keyed by slot * 8 + dir.
+ */
+class CompactDistanceTable {
+public:
+	static constexpr std::int8_t ESCAPE = -128;
+
+	struct Escape {
+		std::uint32_t key;
+		std::int32_t value;
+	};
+
+	CompactDistanceTable() = default;
+	/* views may point into the table's own storage */
+	CompactDistanceTable(const CompactDistanceTable&) = delete;
+	CompactDistanceTable& operator=(const CompactDistanceTable&) = delete;
+
+	/* encode a dense table in memory */
+	void build(const BitGrid& walls, GridView<const DistanceCell> distances);
+	/* use already encoded sections, e.g. from a mapped file */
+	void view(int width, int height, const BitGrid::word* walls, const std::uint32_t* ranks,
+		const std::int8_t* cells, const Escape* escapes, std::size_t escapeCount);
+
+	inline int get(const int& r, const int& c, const int& dir) const;
+	inline bool isOpen(const int& r, const int& c) const;
+	inline std::uint32_t rank(const int& r, const int& c) const;
+	/* the state stays row-major, slots of walls included */
+	inline std::size_t index(const int& r, const int& c) const {
+		return static_cast<std::size_t>(r) * mapWidth + c;
+	}
+
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+	std::size_t wordsPerRow() const { return rowWords; }
+	std::size_t openCells() const;
+	std::size_t escapeCount() const { return escapeEntries; }
+	const BitGrid::word* wallWords() const { return walls; }
+	const std::uint32_t* rankWords() const { return ranks; }
+	const std::int8_t* cellBytes() const { return cells; }
+	const Escape* escapeTable() const { return escapes; }
+	std::size_t bytes() const;
+
+private:
+	int lookupEscape(std::uint32_t key) const;
+
+private:
+	int mapWidth = 0;
+	int mapHeight = 0;
+	std::size_t rowWords = 0;
+	const BitGrid::word* walls = nullptr;
+	const std::uint32_t* ranks = nullptr;
+	const std::int8_t* cells = nullptr;
+	const Escape* escapes = nullptr;
+	std::size_t escapeEntries = 0;
+
+	/* storage when built in memory */
+	BitGrid wallStorage;
+	std::vector<std::uint32_t> rankStorage;
+	std::vector<std::int8_t> cellStorage;
+	std::vector<Escape> escapeStorage;
+};
+
+bool CompactDistanceTable::isOpen(const int& r, const int& c) const {
+	assert(0 <= r && r < mapHeight && 0 <= c && c < mapWidth);
+	return !(walls[r * rowWords + c / 64] >> (c % 64) & 1);
+}
+
+std::uint32_t CompactDistanceTable::rank(const int& r, const int& c) const {
+	std::size_t w = r * rowWords + c / 64;
+	BitGrid::word below = (BitGrid::word(1) << (c % 64)) - 1;
+	return ranks[w] + __builtin_popcountll(~walls[w] & below);
+}
+
+int CompactDistanceTable::get(const int& r, const int& c, const int& dir) const {
+	assert(isOpen(r, c));
+	std::uint32_t key = rank(r, c) * DIRCOUNT + dir;
+	std::int8_t d = cells[key];
+	return d != ESCAPE ? d : lookupEscape(key);
+}
+
+inline void CompactDistanceTable::build(const BitGrid& walls, GridView<const DistanceCell> distances) {
+	wallStorage = walls;
+	rowWords = walls.wordsPerLine();
+	rankStorage.assign(static_cast<std::size_t>(walls.lineCount()) * rowWords, 0);
+	cellStorage.clear();
+	escapeStorage.clear();
+
+	std::uint32_t open = 0;
+	for (int r = 0; r < walls.lineCount(); ++r)
+		for (std::size_t k = 0; k < rowWords; ++k) {
+			rankStorage[r * rowWords + k] = open;
+			open += __builtin_popcountll(~walls.line(r)[k]);
+		}
+
+	cellStorage.reserve(static_cast<std::size_t>(open) * DIRCOUNT);
+	for (int r = 0; r < walls.lineCount(); ++r)
+		for (int c = 0; c < walls.lineLength(); ++c)
+			if (!walls.get(r, c))
+				for (int dir = 0; dir < DIRCOUNT; ++dir) {
+					int d = distances[r][c][dir];
+					if (d <= ESCAPE || d > 127) {
+						escapeStorage.push_back({ static_cast<std::uint32_t>(cellStorage.size()), d });
+						d = ESCAPE;
+					}
+					cellStorage.push_back(static_cast<std::int8_t>(d));
+				}
+
+	const BitGrid::word* wallWords = wallStorage.lineCount() ? wallStorage.line(0) : nullptr;
+	view(walls.lineLength(), walls.lineCount(), wallWords, rankStorage.data(),
+		cellStorage.data(), escapeStorage.data(), escapeStorage.size());
+}
+
+inline void CompactDistanceTable::view(int width, int height, const BitGrid::word* walls,
+	const std::uint32_t* ranks, const std::int8_t* cells, const Escape* escapes, std::size_t escapeCount) {
+	mapWidth = width;
+	mapHeight = height;
+	rowWords = (width + 63) / 64;
+	this->walls = walls;
+	this->ranks = ranks;
+	this->cells = cells;
+	this->escapes = escapes;
+	escapeEntries = escapeCount;
+}
+
+inline std::size_t CompactDistanceTable::openCells() const {
+	if (mapHeight == 0 || rowWords == 0)
+		return 0;
+	std::size_t last = mapHeight * rowWords - 1;
+	return ranks[last] + __builtin_popcountll(~walls[last]);
+}
+
+inline std::size_t CompactDistanceTable::bytes() const {
+	std::size_t words = mapHeight * rowWords;
+	return words * (sizeof(BitGrid::word) + sizeof(std::uint32_t)) +
+		openCells() * DIRCOUNT + escapeEntries * sizeof(Escape);
+}
+
+inline int CompactDistanceTable::lookupEscape(std::uint32_t key) const {
+	const Escape* it = std::lower_bound(escapes, escapes + escapeEntries, key,
+		[](const Escape& e, std::uint32_t k) { return e.key < k; });
+	assert(it != escapes + escapeEntries && it->key == key);
+	return it->value;
+}
+
+/*
+ * Dense distances in blocks of 8x8 cells, the blocks in row-major order and
+ * row-major inside each block. A jump or a search that moves along a column
+ * or a diagonal then stays within a few cache lines and pages, where
+ * row-major order touches a new row, a whole map width away, every step.
+ * The map is padded to whole blocks.
+ */
+class TiledDistanceTable {
+public:
+	static constexpr int SHIFT = 3;
+	static constexpr int SIDE = 1 << SHIFT;
+
+	TiledDistanceTable() = default;
+	/* views may point into the table's own storage */
+	TiledDistanceTable(const TiledDistanceTable&) = delete;
+	TiledDistanceTable& operator=(const TiledDistanceTable&) = delete;
+
+	/* encode the open cells of any other table, isOpen(r, c) telling which */
+	template<typename Table, typename IsOpen>
+	void build(int width, int height, const Table& table, IsOpen isOpen);
+	/* use cells already in this layout, e.g. another table's */
+	void view(int width, int height, const DistanceCell* cells);
+
+	inline int get(const int& r, const int& c, const int& dir) const {
+		return cells[index(r, c)][dir];
+	}
+	inline std::size_t index(const int& r, const int& c) const {
+		assert(0 <= r && r < mapHeight && 0 <= c && c < mapWidth);
+		std::size_t block = static_cast<std::size_t>(r >> SHIFT) * blockCols + (c >> SHIFT);
+		return block << (2 * SHIFT) | (r & (SIDE - 1)) << SHIFT | (c & (SIDE - 1));
+	}
+
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+	/* padded to whole blocks */
+	int paddedWidth() const { return static_cast<int>(blockCols) * SIDE; }
+	int paddedHeight() const { return static_cast<int>(blockRows) * SIDE; }
+	const DistanceCell* cellData() const { return cells; }
+	std::size_t bytes() const { return blockRows * blockCols * SIDE * SIDE * sizeof(DistanceCell); }
+
+private:
+	int mapWidth = 0;
+	int mapHeight = 0;
+	std::size_t blockRows = 0;
+	std::size_t blockCols = 0;
+	const DistanceCell* cells = nullptr;
+
+	/* storage when built in memory, one grid row per block */
+	Grid<DistanceCell> storage;
+};
+
+template<typename Table, typename IsOpen>
+void TiledDistanceTable::build(int width, int height, const Table& table, IsOpen isOpen) {
+	std::size_t rows = (height + SIDE - 1) >> SHIFT;
+	std::size_t cols = (width + SIDE - 1) >> SHIFT;
+	storage.resize(static_cast<int>(rows * cols), SIDE * SIDE);
+	view(width, height, storage.data());
+	for (int r = 0; r < height; ++r)
+		for (int c = 0; c < width; ++c)
+			if (isOpen(r, c))
+				for (int dir = 0; dir < DIRCOUNT; ++dir)
+					storage.data()[index(r, c)][dir] = table.get(r, c, dir);
+}
+
+inline void TiledDistanceTable::view(int width, int height, const DistanceCell* cells) {
+	mapWidth = width;
+	mapHeight = height;
+	blockRows = (height + SIDE - 1) >> SHIFT;
+	blockCols = (width + SIDE - 1) >> SHIFT;
+	this->cells = cells;
+}
+
+#endif /* DISTANCETABLE_HPP */
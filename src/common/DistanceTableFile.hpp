@@ -0,0 +1,430 @@
+#ifndef DISTANCETABLEFILE_HPP
+#define DISTANCETABLEFILE_HPP
+
+#include "BitGrid.hpp"
+#include "DistanceTable.hpp"
+#include "Grid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Versioned binary distance table written by preprocessing and mapped by the
+ * runtime. A 128-byte header is followed by page-aligned sections stored in
+ * host (little-endian) byte order, so the runtime uses them in place:
+ *
+ *   WALLS      height rows of ceil(width / 64) words, bit c%64 of word c/64
+ *              set for a wall, bits past the map border set as well
+ *   DISTANCES  LAYOUT_DENSE: int32[height][width][8] in direction order
+ *              NORTH, SOUTH, WEST, EAST, NORTHWEST, NORTHEAST, SOUTHWEST,
+ *              SOUTHEAST; all zero for walls
+ *              LAYOUT_COMPACT: int8[open cells][8] in the same order, see
+ *              CompactDistanceTable
+ *   RANKS      LAYOUT_COMPACT only: uint32 open cells before each WALLS word,
+ *              padded to a multiple of 8 bytes
+ *   ESCAPES    LAYOUT_COMPACT only: sorted CompactDistanceTable::Escape
+ *
+ * The checksum is FNV-1a over the 64-bit words following the header.
+ */
+struct DistanceTableHeader {
+	struct Section {
+		std::uint64_t offset;
+		std::uint64_t bytes;
+	};
+
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t layout;
+	std::int32_t width;
+	std::int32_t height;
+	std::uint64_t openCells;
+	std::uint64_t fileSize;
+	std::uint64_t checksum;
+	Section sections[5];
+};
+static_assert(sizeof(DistanceTableHeader) == 128, "header layout is part of the file format");
+
+class DistanceTableFile {
+public:
+	static constexpr char MAGIC[8] = { 'J', 'P', 'S', 'P', 'L', 'U', 'S', '\0' };
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::uint64_t SECTIONALIGN = 4096;
+
+	enum layout : std::uint32_t {
+		LAYOUT_DENSE = 0, LAYOUT_COMPACT
+	};
+	enum section {
+		WALLS = 0, DISTANCES, RANKS, ESCAPES
+	};
+
+	static bool write(const std::string& path, const BitGrid& walls, const Grid<DistanceCell>& distance,
+		layout tableLayout = LAYOUT_DENSE);
+	static std::uint64_t checksum(const void* data, std::size_t bytes,
+		std::uint64_t hash = 14695981039346656037ULL);
+
+	/* header with everything but the sections, counts and checksum filled in */
+	static DistanceTableHeader emptyHeader(layout tableLayout, int width, int height);
+	static std::uint64_t alignSection(std::uint64_t offset) {
+		return (offset + SECTIONALIGN - 1) / SECTIONALIGN * SECTIONALIGN;
+	}
+};
+
+/*
+ * LAYOUT_DENSE table written in place for producers that finish rows out of
+ * order and cannot hold the whole table: the file is sized up front, rows of
+ * either section are read and written back by position, and finish() fills
+ * in the header once every row is final.
+ */
+class DistanceTableStream {
+public:
+	DistanceTableStream() = default;
+	DistanceTableStream(const DistanceTableStream&) = delete;
+	DistanceTableStream& operator=(const DistanceTableStream&) = delete;
+	~DistanceTableStream();
+
+	bool create(const std::string& path, int width, int height);
+	/* `count` consecutive rows starting at `row` */
+	bool writeWalls(int row, int count, const BitGrid::word* words);
+	bool readWalls(int row, int count, BitGrid::word* words);
+	bool writeDistances(int row, int count, const DistanceCell* cells);
+	bool readDistances(int row, int count, DistanceCell* cells);
+	bool finish();
+
+private:
+	bool transfer(bool write, std::uint64_t offset, void* data, std::size_t bytes);
+	void close();
+
+private:
+	int fd = -1;
+	std::string path;
+	std::size_t rowWords = 0;
+	DistanceTableHeader header;
+};
+
+/*
+ * Read-only shared mapping of a table file. All processes mapping the same
+ * file share one page-cache copy; nothing is parsed or copied on load.
+ */
+class MappedDistanceTable {
+public:
+	MappedDistanceTable() = default;
+	MappedDistanceTable(const MappedDistanceTable&) = delete;
+	MappedDistanceTable& operator=(const MappedDistanceTable&) = delete;
+	~MappedDistanceTable();
+
+	/* checks magic, version and section bounds; the full checksum pass
+	 * touches every page, so it only runs on request */
+	bool map(const std::string& path, bool verifyChecksum = false);
+	void unmap();
+
+	const DistanceTableHeader& header() const { return *static_cast<const DistanceTableHeader*>(base); }
+	DistanceTableFile::layout layout() const { return static_cast<DistanceTableFile::layout>(header().layout); }
+	const BitGrid::word* walls() const { return section<BitGrid::word>(DistanceTableFile::WALLS); }
+	/* LAYOUT_DENSE */
+	DenseDistanceTable dense() const;
+	/* LAYOUT_COMPACT, points `table` at the mapped sections */
+	void compact(CompactDistanceTable& table) const;
+
+private:
+	template<typename T>
+	const T* section(int id) const {
+		return reinterpret_cast<const T*>(static_cast<const char*>(base) + header().sections[id].offset);
+	}
+
+private:
+	void* base = nullptr;
+	std::size_t size = 0;
+};
+
+inline std::uint64_t DistanceTableFile::checksum(const void* data, std::size_t bytes, std::uint64_t hash) {
+	const std::uint64_t* words = static_cast<const std::uint64_t*>(data);
+	for (std::size_t i = 0; i < bytes / sizeof(std::uint64_t); ++i)
+		hash = (hash ^ words[i]) * 1099511628211ULL;
+	return hash;
+}
+
+inline bool DistanceTableFile::write(const std::string& path, const BitGrid& walls,
+	const Grid<DistanceCell>& distance, layout tableLayout) {
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+
+	DistanceTableHeader header = emptyHeader(tableLayout, distance.width(), distance.height());
+
+	/* every put is a multiple of 8 bytes so that the running checksum
+	 * matches one pass over the whole file */
+	std::uint64_t offset = sizeof(header);
+	bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	auto put = [&](const void* data, std::size_t bytes) {
+		assert(bytes % sizeof(std::uint64_t) == 0);
+		ok = ok && std::fwrite(data, 1, bytes, file) == bytes;
+		header.checksum = checksum(data, bytes, header.checksum);
+		offset += bytes;
+	};
+	auto beginSection = [&](int id) {
+		static const char zeros[SECTIONALIGN] = {};
+		put(zeros, alignSection(offset) - offset);
+		header.sections[id] = { offset, 0 };
+	};
+	auto endSection = [&](int id) {
+		header.sections[id].bytes = offset - header.sections[id].offset;
+	};
+
+	/* walls, one packed row at a time */
+	beginSection(WALLS);
+	for (int r = 0; r < walls.lineCount(); ++r) {
+		const BitGrid::word* line = walls.line(r);
+		put(line, walls.wordsPerLine() * sizeof(BitGrid::word));
+		for (int k = 0; k < walls.wordsPerLine(); ++k)
+			header.openCells += __builtin_popcountll(~line[k]);
+	}
+	endSection(WALLS);
+
+	if (tableLayout == LAYOUT_DENSE) {
+		/* dense distances, zeroing walls so the file does not depend on
+		 * whatever the preprocessing left in them */
+		beginSection(DISTANCES);
+		std::vector<DistanceCell> row(distance.width());
+		for (int r = 0; r < distance.height(); ++r) {
+			for (int c = 0; c < distance.width(); ++c)
+				row[c] = walls.get(r, c) ? DistanceCell{} : distance[r][c];
+			put(row.data(), row.size() * sizeof(DistanceCell));
+		}
+		endSection(DISTANCES);
+	}
+	else {
+		CompactDistanceTable compact;
+		compact.build(walls, GridView<const DistanceCell>(distance.data(), distance.height(), distance.width()));
+
+		beginSection(DISTANCES);
+		put(compact.cellBytes(), compact.openCells() * DIRCOUNT);
+		endSection(DISTANCES);
+
+		beginSection(RANKS);
+		std::size_t words = compact.wordsPerRow() * compact.height();
+		std::vector<std::uint32_t> ranks(compact.rankWords(), compact.rankWords() + words);
+		ranks.resize((words + 1) / 2 * 2, 0);
+		put(ranks.data(), ranks.size() * sizeof(std::uint32_t));
+		endSection(RANKS);
+
+		beginSection(ESCAPES);
+		put(compact.escapeTable(), compact.escapeCount() * sizeof(CompactDistanceTable::Escape));
+		endSection(ESCAPES);
+	}
+	header.fileSize = offset;
+
+	ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		std::perror(path.c_str());
+	return ok;
+}
+
+inline DistanceTableHeader DistanceTableFile::emptyHeader(layout tableLayout, int width, int height) {
+	DistanceTableHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.layout = tableLayout;
+	header.width = width;
+	header.height = height;
+	header.checksum = checksum(nullptr, 0);
+	return header;
+}
+
+inline DistanceTableStream::~DistanceTableStream() {
+	close();
+}
+
+inline bool DistanceTableStream::create(const std::string& path, int width, int height) {
+	close();
+	this->path = path;
+	rowWords = (width + BitGrid::WORDBITS - 1) / BitGrid::WORDBITS;
+	header = DistanceTableFile::emptyHeader(DistanceTableFile::LAYOUT_DENSE, width, height);
+
+	DistanceTableHeader::Section& walls = header.sections[DistanceTableFile::WALLS];
+	DistanceTableHeader::Section& distances = header.sections[DistanceTableFile::DISTANCES];
+	walls.offset = DistanceTableFile::alignSection(sizeof(header));
+	walls.bytes = static_cast<std::uint64_t>(height) * rowWords * sizeof(BitGrid::word);
+	distances.offset = DistanceTableFile::alignSection(walls.offset + walls.bytes);
+	distances.bytes = static_cast<std::uint64_t>(height) * width * sizeof(DistanceCell);
+	header.fileSize = distances.offset + distances.bytes;
+
+	/* the gaps between sections read back as zeros, as write() pads them */
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ::ftruncate(fd, header.fileSize) < 0) {
+		std::perror(path.c_str());
+		close();
+		return false;
+	}
+	return true;
+}
+
+inline bool DistanceTableStream::writeWalls(int row, int count, const BitGrid::word* words) {
+	for (std::size_t k = 0; k < count * rowWords; ++k)
+		header.openCells += __builtin_popcountll(~words[k]);
+	return transfer(true, header.sections[DistanceTableFile::WALLS].offset + row * rowWords * sizeof(BitGrid::word),
+		const_cast<BitGrid::word*>(words), count * rowWords * sizeof(BitGrid::word));
+}
+
+inline bool DistanceTableStream::readWalls(int row, int count, BitGrid::word* words) {
+	return transfer(false, header.sections[DistanceTableFile::WALLS].offset + row * rowWords * sizeof(BitGrid::word),
+		words, count * rowWords * sizeof(BitGrid::word));
+}
+
+inline bool DistanceTableStream::writeDistances(int row, int count, const DistanceCell* cells) {
+	std::size_t rowBytes = static_cast<std::size_t>(header.width) * sizeof(DistanceCell);
+	return transfer(true, header.sections[DistanceTableFile::DISTANCES].offset + row * rowBytes,
+		const_cast<DistanceCell*>(cells), count * rowBytes);
+}
+
+inline bool DistanceTableStream::readDistances(int row, int count, DistanceCell* cells) {
+	std::size_t rowBytes = static_cast<std::size_t>(header.width) * sizeof(DistanceCell);
+	return transfer(false, header.sections[DistanceTableFile::DISTANCES].offset + row * rowBytes,
+		cells, count * rowBytes);
+}
+
+/* checksums the finished sections in one sequential pass and writes the header */
+inline bool DistanceTableStream::finish() {
+	std::vector<std::uint64_t> chunk(1 << 17);
+	std::uint64_t offset = sizeof(header);
+	while (offset < header.fileSize) {
+		std::size_t bytes = std::min<std::uint64_t>(chunk.size() * sizeof(std::uint64_t), header.fileSize - offset);
+		if (!transfer(false, offset, chunk.data(), bytes))
+			return false;
+		header.checksum = DistanceTableFile::checksum(chunk.data(), bytes, header.checksum);
+		offset += bytes;
+	}
+
+	bool ok = transfer(true, 0, &header, sizeof(header));
+	close();
+	return ok;
+}
+
+inline bool DistanceTableStream::transfer(bool write, std::uint64_t offset, void* data, std::size_t bytes) {
+	char* p = static_cast<char*>(data);
+	while (bytes) {
+		ssize_t n = write ? ::pwrite(fd, p, bytes, offset) : ::pread(fd, p, bytes, offset);
+		if (n <= 0) {
+			std::perror(path.c_str());
+			return false;
+		}
+		p += n;
+		offset += n;
+		bytes -= n;
+	}
+	return true;
+}
+
+inline void DistanceTableStream::close() {
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+inline MappedDistanceTable::~MappedDistanceTable() {
+	unmap();
+}
+
+inline bool MappedDistanceTable::map(const std::string& path, bool verifyChecksum) {
+	unmap();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::perror(path.c_str());
+		return false;
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) < sizeof(DistanceTableHeader)) {
+		std::fprintf(stderr, "%s: not a distance table\n", path.c_str());
+		::close(fd);
+		return false;
+	}
+
+	size = st.st_size;
+	base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (base == MAP_FAILED) {
+		base = nullptr;
+		std::perror(path.c_str());
+		return false;
+	}
+
+	const DistanceTableHeader& h = header();
+	const char* error = nullptr;
+	if (std::memcmp(h.magic, DistanceTableFile::MAGIC, sizeof(h.magic)) != 0)
+		error = "not a distance table";
+	else if (h.version != DistanceTableFile::VERSION)
+		error = "unsupported table version";
+	else if (h.layout != DistanceTableFile::LAYOUT_DENSE && h.layout != DistanceTableFile::LAYOUT_COMPACT)
+		error = "unsupported table layout";
+	else if (h.fileSize != size || h.width < 0 || h.height < 0)
+		error = "truncated table";
+	else {
+		bool dense = h.layout == DistanceTableFile::LAYOUT_DENSE;
+		std::uint64_t words = static_cast<std::uint64_t>(h.height) * ((h.width + 63) / 64);
+		/* indexed by section */
+		std::uint64_t expected[] = {
+			words * sizeof(BitGrid::word),
+			dense ? static_cast<std::uint64_t>(h.height) * h.width * sizeof(DistanceCell) : h.openCells * DIRCOUNT,
+			dense ? 0 : (words + 1) / 2 * 8,
+			h.sections[DistanceTableFile::ESCAPES].bytes / sizeof(CompactDistanceTable::Escape)
+				* sizeof(CompactDistanceTable::Escape),
+		};
+		for (int id = DistanceTableFile::WALLS; id <= DistanceTableFile::ESCAPES; ++id) {
+			const DistanceTableHeader::Section& sec = h.sections[id];
+			if (sec.bytes && (sec.offset % DistanceTableFile::SECTIONALIGN || sec.offset + sec.bytes > size))
+				error = "truncated table";
+			else if (sec.bytes != expected[id])
+				error = "table size does not match its header";
+		}
+	}
+	if (!error && verifyChecksum &&
+		DistanceTableFile::checksum(static_cast<const char*>(base) + sizeof(h), size - sizeof(h)) != h.checksum)
+		error = "checksum mismatch";
+
+	if (error) {
+		std::fprintf(stderr, "%s: %s\n", path.c_str(), error);
+		unmap();
+		return false;
+	}
+	return true;
+}
+
+inline void MappedDistanceTable::unmap() {
+	if (base)
+		::munmap(base, size);
+	base = nullptr;
+	size = 0;
+}
+
+inline DenseDistanceTable MappedDistanceTable::dense() const {
+	assert(layout() == DistanceTableFile::LAYOUT_DENSE);
+	return DenseDistanceTable(GridView<const DistanceCell>(
+		section<DistanceCell>(DistanceTableFile::DISTANCES), header().height, header().width));
+}
+
+inline void MappedDistanceTable::compact(CompactDistanceTable& table) const {
+	assert(layout() == DistanceTableFile::LAYOUT_COMPACT);
+	const DistanceTableHeader& h = header();
+	table.view(h.width, h.height, walls(),
+		section<std::uint32_t>(DistanceTableFile::RANKS),
+		section<std::int8_t>(DistanceTableFile::DISTANCES),
+		section<CompactDistanceTable::Escape>(DistanceTableFile::ESCAPES),
+		h.sections[DistanceTableFile::ESCAPES].bytes / sizeof(CompactDistanceTable::Escape));
+}
+
+#endif /* DISTANCETABLEFILE_HPP */
@@ -0,0 +1,170 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/*
+ * Runtime-sized, row-major 2D storage in a single cache-line aligned block.
+ * Indexing grid[r][c] behaves like the fixed T[H][W] arrays it replaces,
+ * so per-cell arrays (e.g. Grid<std::array<int, 8>>) keep the familiar
+ * grid[r][c][dir] syntax. Cells are zero-initialized on resize(). Grids of
+ * a huge page or more are aligned to one and offered to transparent huge
+ * pages, so that large maps take fewer TLB misses.
+ */
+template<typename T>
+class Grid {
+	static_assert(std::is_trivially_copyable<T>::value,
+		"Grid cells are zeroed and moved with memset/memcpy");
+
+public:
+	static constexpr std::size_t ALIGNMENT = 64;
+	static constexpr std::size_t HUGEPAGE = 2 << 20;
+
+	Grid() = default;
+	Grid(int height, int width);
+	Grid(const Grid& o);
+	Grid(Grid&& o) noexcept;
+	Grid& operator=(Grid o) noexcept;
+	~Grid();
+
+	void resize(int height, int width);
+	void fill(const T& value);
+
+	inline T* operator[](const int& r);
+	inline const T* operator[](const int& r) const;
+
+	T* data() { return cells; }
+	const T* data() const { return cells; }
+	int height() const { return gridHeight; }
+	int width() const { return gridWidth; }
+	std::size_t size() const { return static_cast<std::size_t>(gridHeight) * gridWidth; }
+	std::size_t bytes() const { return size() * sizeof(T); }
+
+private:
+	void release();
+
+private:
+	T* cells = nullptr;
+	int gridHeight = 0;
+	int gridWidth = 0;
+};
+
+/*
+ * Non-owning view with the same grid[r][c] indexing, over a Grid or over any
+ * other row-major block of cells (e.g. a memory-mapped table).
+ */
+template<typename T>
+class GridView {
+public:
+	GridView() = default;
+	GridView(T* cells, int height, int width)
+		: cells(cells), gridHeight(height), gridWidth(width) {}
+	template<typename U>
+	GridView(Grid<U>& grid) : GridView(grid.data(), grid.height(), grid.width()) {}
+
+	inline T* operator[](const int& r) const {
+		assert(0 <= r && r < gridHeight);
+		return cells + static_cast<std::size_t>(r) * gridWidth;
+	}
+
+	T* data() const { return cells; }
+	int height() const { return gridHeight; }
+	int width() const { return gridWidth; }
+
+private:
+	T* cells = nullptr;
+	int gridHeight = 0;
+	int gridWidth = 0;
+};
+
+template<typename T>
+Grid<T>::Grid(int height, int width) {
+	resize(height, width);
+}
+
+template<typename T>
+Grid<T>::Grid(const Grid& o) {
+	resize(o.gridHeight, o.gridWidth);
+	if (cells)
+		std::memcpy(cells, o.cells, bytes());
+}
+
+template<typename T>
+Grid<T>::Grid(Grid&& o) noexcept
+	: cells(o.cells), gridHeight(o.gridHeight), gridWidth(o.gridWidth) {
+	o.cells = nullptr;
+	o.gridHeight = o.gridWidth = 0;
+}
+
+template<typename T>
+Grid<T>& Grid<T>::operator=(Grid o) noexcept {
+	std::swap(cells, o.cells);
+	std::swap(gridHeight, o.gridHeight);
+	std::swap(gridWidth, o.gridWidth);
+	return *this;
+}
+
+template<typename T>
+Grid<T>::~Grid() {
+	release();
+}
+
+template<typename T>
+void Grid<T>::resize(int height, int width) {
+	assert(height >= 0 && width >= 0);
+	release();
+	gridHeight = height;
+	gridWidth = width;
+	if (size() == 0)
+		return;
+
+	/* aligned_alloc wants the size to be a multiple of the alignment */
+	std::size_t alignment = bytes() >= HUGEPAGE ? HUGEPAGE : ALIGNMENT;
+	std::size_t allocSize = (bytes() + alignment - 1) / alignment * alignment;
+	cells = static_cast<T*>(std::aligned_alloc(alignment, allocSize));
+	if (!cells)
+		throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+	/* before the memset faults the pages in; only a hint */
+	if (alignment == HUGEPAGE)
+		::madvise(cells, allocSize, MADV_HUGEPAGE);
+#endif
+	std::memset(static_cast<void*>(cells), 0, allocSize);
+}
+
+template<typename T>
+void Grid<T>::fill(const T& value) {
+	for (std::size_t i = 0; i < size(); ++i)
+		cells[i] = value;
+}
+
+template<typename T>
+T* Grid<T>::operator[](const int& r) {
+	assert(0 <= r && r < gridHeight);
+	return cells + static_cast<std::size_t>(r) * gridWidth;
+}
+
+template<typename T>
+const T* Grid<T>::operator[](const int& r) const {
+	assert(0 <= r && r < gridHeight);
+	return cells + static_cast<std::size_t>(r) * gridWidth;
+}
+
+template<typename T>
+void Grid<T>::release() {
+	std::free(cells);
+	cells = nullptr;
+	gridHeight = gridWidth = 0;
+}
+
+#endif /* GRID_HPP */
@@ -0,0 +1,113 @@
+#ifndef MAPFORMAT_HPP
+#define MAPFORMAT_HPP
+
+#include "BitGrid.hpp"
+#include "Scanner.hpp"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/*
+ * Map input in either of two formats, told apart by the first token:
+ *
+ *   native    "width height" followed by rows of '#' (wall) and '.' (open)
+ *   MovingAI  "type octile", "height H", "width W" and "map" lines followed
+ *             by rows of terrain; '.', 'G' and 'S' are passable, everything
+ *             else ('@', 'O', 'T', 'W') is a wall
+ */
+inline bool isOpenTerrain(const int& c) {
+	return c == '.' || c == 'G' || c == 'S';
+}
+
+/* isOpenTerrain() of 8 characters at once, bit i for p[i] (SWAR byte
+ * compares, then the high bit of every byte gathered by a multiply) */
+inline unsigned openTerrainMask(const char* p) {
+	constexpr std::uint64_t ONES = 0x0101010101010101ULL;
+	constexpr std::uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+	std::uint64_t x;
+	std::memcpy(&x, p, sizeof(x));
+
+	/* high bit of every byte equal to ch */
+	auto equal = [&](char ch) {
+		std::uint64_t t = x ^ (ONES * static_cast<unsigned char>(ch));
+		return ~(((t & LOW7) + LOW7) | t | LOW7);
+	};
+	std::uint64_t open = equal('.') | equal('G') | equal('S');
+	return static_cast<unsigned>(((open >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+inline bool readMapHeader(Scanner& in, int& width, int& height) {
+	std::string token;
+	if (!in.readToken(token))
+		return false;
+
+	if (token == "type") {
+		width = height = -1;
+		in.readToken(token); /* octile */
+		while (in.readToken(token) && token != "map") {
+			if (token == "height")
+				in.readInt(height);
+			else if (token == "width")
+				in.readInt(width);
+		}
+		if (token != "map" || width < 0 || height < 0) {
+			std::fprintf(stderr, "malformed MovingAI map header\n");
+			return false;
+		}
+		return true;
+	}
+
+	char* endp;
+	width = std::strtol(token.c_str(), &endp, 10);
+	if (*endp || !in.readInt(height) || width < 0 || height < 0) {
+		std::fprintf(stderr, "malformed map header\n");
+		return false;
+	}
+	return true;
+}
+
+/* one row of `width` cells into bit-packed walls, padding bits set */
+inline bool readMapRow(Scanner& in, const int& width, BitGrid::word* out) {
+	using word = BitGrid::word;
+	in.skipSpace();
+
+	int c = 0;
+	if (in.request(width + 1) >= static_cast<std::size_t>(width)) {
+		/* the whole row is buffered: 64 cells per word without per-cell
+		 * end-of-buffer checks */
+		const char* row = in.data();
+		for (; c + BitGrid::WORDBITS <= width; c += BitGrid::WORDBITS) {
+			word bits = 0;
+			for (int i = 0; i < BitGrid::WORDBITS; i += 8)
+				bits |= word(openTerrainMask(row + c + i)) << i;
+			out[c / BitGrid::WORDBITS] = ~bits;
+		}
+		in.skip(c);
+	}
+
+	word bits = 0;
+	for (; c < width; ++c) {
+		int ch = in.get();
+		if (ch == EOF || ch <= ' ')
+			break;
+		bits |= word(!isOpenTerrain(ch)) << (c % BitGrid::WORDBITS);
+		if (c % BitGrid::WORDBITS == BitGrid::WORDBITS - 1) {
+			out[c / BitGrid::WORDBITS] = bits;
+			bits = 0;
+		}
+	}
+
+	int next = in.peek();
+	if (c < width || (next != EOF && next > ' ')) {
+		std::fprintf(stderr, "malformed map row\n");
+		return false;
+	}
+	if (width % BitGrid::WORDBITS)
+		out[width / BitGrid::WORDBITS] = bits | ~word(0) << (width % BitGrid::WORDBITS);
+	return true;
+}
+
+#endif /* MAPFORMAT_HPP */
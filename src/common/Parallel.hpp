@@ -0,0 +1,41 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/*
+ * Runs f(t) for t in [0, threads) with one thread each; the calling thread
+ * takes t = 0. A single thread runs inline without spawning anything.
+ */
+template<typename F>
+void parallelRun(int threads, F&& f) {
+	std::vector<std::thread> workers;
+	workers.reserve(std::max(threads - 1, 0));
+	for (int t = 1; t < threads; ++t)
+		workers.emplace_back([&f, t]() { f(t); });
+	f(0);
+	for (auto& worker : workers)
+		worker.join();
+}
+
+/*
+ * Splits [0, count) into `threads` contiguous chunks of near-equal size and
+ * runs f(begin, end) for each of them in parallel.
+ */
+template<typename F>
+void parallelFor(int threads, int count, F&& f) {
+	threads = std::max(1, std::min(threads, count));
+	parallelRun(threads, [&](int t) {
+		int begin = static_cast<int>(static_cast<long long>(count) * t / threads);
+		int end = static_cast<int>(static_cast<long long>(count) * (t + 1) / threads);
+		f(begin, end);
+	});
+}
+
+inline int hardwareThreads() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+#endif /* PARALLEL_HPP */
@@ -0,0 +1,196 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Buffered whitespace-separated input over a file descriptor, a replacement
+ * for token-by-token std::cin. Input is read in large blocks and integers
+ * are parsed by hand. The buffer has a fixed size, so streaming readers stay
+ * bounded in memory however large the input is.
+ *
+ * All stdin readers must go through standardInput(): once it has buffered
+ * a block, std::cin can no longer see that input.
+ */
+class Scanner {
+public:
+	static constexpr std::size_t CAPACITY = 1 << 20;
+
+	explicit Scanner(int fd = -1) : fd(fd), buffer(CAPACITY) {}
+	Scanner(const Scanner&) = delete;
+	Scanner& operator=(const Scanner&) = delete;
+	~Scanner();
+
+	static Scanner& standardInput();
+
+	bool open(const std::string& path);
+	/* read from `fd` (not owned) from now on, dropping anything buffered */
+	void attach(int fd);
+	/* read a copy of `bytes` (at most CAPACITY) at `data` instead, followed
+	 * by the end of the input */
+	void assign(const char* data, std::size_t bytes);
+
+	/* next character, or EOF */
+	inline int get();
+	inline int peek();
+	/* skips whitespace and returns the next character without consuming it */
+	inline int skipSpace();
+
+	bool readInt(int& x);
+	bool readToken(std::string& token);
+
+	/* buffers at least `n` bytes (fewer only at the end of the input, or if
+	 * n exceeds CAPACITY) and returns how many are available at data() */
+	std::size_t request(std::size_t n);
+	const char* data() const { return cur; }
+	void skip(std::size_t n) { cur += n; }
+
+private:
+	bool refill();
+	ssize_t read(char* to, std::size_t bytes);
+
+private:
+	int fd;
+	bool owned = false;
+	std::vector<char> buffer;
+	const char* cur = nullptr;
+	const char* end = nullptr;
+};
+
+int Scanner::get() {
+	if (cur == end && !refill())
+		return EOF;
+	return static_cast<unsigned char>(*cur++);
+}
+
+int Scanner::peek() {
+	if (cur == end && !refill())
+		return EOF;
+	return static_cast<unsigned char>(*cur);
+}
+
+int Scanner::skipSpace() {
+	for (;;) {
+		while (cur != end && static_cast<unsigned char>(*cur) <= ' ')
+			++cur;
+		if (cur != end || !refill())
+			return peek();
+	}
+}
+
+inline Scanner::~Scanner() {
+	if (owned)
+		::close(fd);
+}
+
+inline Scanner& Scanner::standardInput() {
+	static Scanner input(STDIN_FILENO);
+	return input;
+}
+
+inline bool Scanner::open(const std::string& path) {
+	if (owned)
+		::close(fd);
+	fd = ::open(path.c_str(), O_RDONLY);
+	owned = fd >= 0;
+	cur = end = nullptr;
+	if (fd < 0)
+		std::perror(path.c_str());
+	return fd >= 0;
+}
+
+inline void Scanner::attach(int fd) {
+	if (owned)
+		::close(this->fd);
+	this->fd = fd;
+	owned = false;
+	cur = end = nullptr;
+}
+
+inline void Scanner::assign(const char* data, std::size_t bytes) {
+	attach(-1);
+	bytes = std::min(bytes, buffer.size());
+	std::memcpy(buffer.data(), data, bytes);
+	cur = buffer.data();
+	end = cur + bytes;
+}
+
+inline bool Scanner::readInt(int& x) {
+	int c = skipSpace();
+	bool negative = c == '-';
+	if (negative || c == '+') {
+		get();
+		c = peek();
+	}
+	if (c < '0' || c > '9')
+		return false;
+
+	long long value = 0;
+	/* digits within the buffer are the common case and skip the refill check */
+	for (;;) {
+		while (cur != end && static_cast<unsigned>(*cur - '0') < 10)
+			value = value * 10 + (*cur++ - '0');
+		if (cur != end || !refill())
+			break;
+	}
+	x = static_cast<int>(negative ? -value : value);
+	return true;
+}
+
+inline bool Scanner::readToken(std::string& token) {
+	token.clear();
+	int c = skipSpace();
+	while (c != EOF && c > ' ') {
+		token.push_back(static_cast<char>(get()));
+		c = peek();
+	}
+	return !token.empty();
+}
+
+inline std::size_t Scanner::request(std::size_t n) {
+	n = std::min(n, buffer.size());
+	if (static_cast<std::size_t>(end - cur) < n) {
+		/* keep the unread tail and append to it */
+		std::size_t kept = end - cur;
+		std::memmove(buffer.data(), cur, kept);
+		cur = buffer.data();
+		end = cur + kept;
+		while (static_cast<std::size_t>(end - cur) < n) {
+			ssize_t r = read(const_cast<char*>(end), buffer.data() + buffer.size() - end);
+			if (r <= 0)
+				break;
+			end += r;
+		}
+	}
+	return end - cur;
+}
+
+inline bool Scanner::refill() {
+	ssize_t n = read(buffer.data(), buffer.size());
+	if (n <= 0)
+		return false;
+	cur = buffer.data();
+	end = cur + n;
+	return true;
+}
+
+inline ssize_t Scanner::read(char* to, std::size_t bytes) {
+	if (fd < 0)
+		return 0;
+	ssize_t n;
+	do
+		n = ::read(fd, to, bytes);
+	while (n < 0 && errno == EINTR);
+	return n;
+}
+
+#endif /* SCANNER_HPP */
@@ -0,0 +1,90 @@
+#ifndef FLOWFIELD_HPP
+#define FLOWFIELD_HPP
+
+#include "Direction.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * The next step toward one goal from every cell, four bits a cell, filled
+ * by Runtime::buildFlowField(). Agents sharing the goal follow it with one
+ * lookup per step, along optimal paths, instead of a search each.
+ */
+class FlowField {
+public:
+	struct Cell {
+		int row, col;
+	};
+
+	/* every cell NONE */
+	inline void reset(int height, int width, int goalRow, int goalCol);
+
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+	/* -1 if there was no goal to reach */
+	int getGoalRow() const { return goalRow; }
+	int getGoalCol() const { return goalCol; }
+	std::size_t bytes() const { return steps.size(); }
+	/* wall-clock time of the last Runtime::buildFlowField(), in ms */
+	double getBuildTime() const { return buildTime; }
+
+	/* NONE at the goal and wherever it cannot be reached from */
+	inline direction next(const int& row, const int& col) const;
+
+	/* the cells from (row, col) to the goal and their cost in steps; false
+	 * and no cells if the goal cannot be reached from there */
+	inline bool walk(int row, int col, std::vector<Cell>& path, double& cost) const;
+
+private:
+	friend class Runtime;
+	inline void set(const int& row, const int& col, const direction& dir);
+
+private:
+	int mapWidth = 0;
+	int mapHeight = 0;
+	int goalRow = -1;
+	int goalCol = -1;
+	/* cell i in the low (even i) or high (odd i) half of byte i / 2 */
+	std::vector<std::uint8_t> steps;
+	double buildTime = 0;
+};
+
+void FlowField::reset(int height, int width, int goalRow, int goalCol) {
+	mapWidth = width;
+	mapHeight = height;
+	this->goalRow = goalRow;
+	this->goalCol = goalCol;
+	steps.assign((static_cast<std::size_t>(height) * width + 1) / 2, NONE << 4 | NONE);
+}
+
+direction FlowField::next(const int& row, const int& col) const {
+	std::size_t i = static_cast<std::size_t>(row) * mapWidth + col;
+	return static_cast<direction>(steps[i / 2] >> (i % 2 * 4) & 15);
+}
+
+void FlowField::set(const int& row, const int& col, const direction& dir) {
+	std::size_t i = static_cast<std::size_t>(row) * mapWidth + col;
+	int shift = i % 2 * 4;
+	steps[i / 2] = static_cast<std::uint8_t>((steps[i / 2] & ~(15 << shift)) | dir << shift);
+}
+
+bool FlowField::walk(int row, int col, std::vector<Cell>& path, double& cost) const {
+	path.assign(1, { row, col });
+	cost = 0;
+	for (direction dir; (dir = next(row, col)) != NONE;) {
+		row += drow[dir];
+		col += dcol[dir];
+		cost += isCardinal(dir) ? 1 : std::sqrt(2.0);
+		path.push_back({ row, col });
+	}
+	if (row == goalRow && col == goalCol)
+		return true;
+	path.clear();
+	cost = INFINITY;
+	return false;
+}
+
+#endif /* FLOWFIELD_HPP */
@@ -0,0 +1,110 @@
+#include "GoalBounds.hpp"
+#include "GridFlood.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/* costs are sums of 1 and sqrt(2) and equal ones may differ by rounding */
+constexpr double EPSILON = 1e-7;
+
+}
+
+bool GoalBounds::build(const BitGrid& walls, int threads) {
+	auto start = std::chrono::steady_clock::now();
+	const int height = walls.lineCount();
+	const int width = walls.lineLength();
+	if (width > MAXSIDE || height > MAXSIDE) {
+		std::fprintf(stderr, "goal bounding supports maps up to %dx%d\n", MAXSIDE, MAXSIDE);
+		return false;
+	}
+	boxes.resize(height, width);
+
+	/* rows of sources are handed out one at a time, floods differ a lot
+	 * in size */
+	std::atomic<int> nextRow(0);
+	parallelRun(std::max(1, threads), [&](int) {
+		GridFlood flood(EPSILON);
+		flood.setArea(walls);
+		/* the directions leaving the source that optimal paths to a cell
+		 * start with, one bit per direction */
+		std::vector<std::uint8_t> first(flood.size());
+
+		for (int sr; (sr = nextRow++) < height;)
+			for (int sc = 0; sc < width; ++sc) {
+				BoxCell& box = boxes[sr][sc];
+				for (Box& b : box)
+					b = { 0xFFFF, 0, 0xFFFF, 0 };
+				if (walls.get(sr, sc))
+					continue;
+
+				const int source = flood.index(sr, sc);
+				auto via = [&](int u, int dir) -> std::uint8_t { return u == source ? 1 << dir : first[u]; };
+				flood.run(source,
+					[&](int u) {
+						if (u == source)
+							return;
+						int ur = flood.rowOf(u), uc = flood.colOf(u);
+						for (unsigned bits = first[u]; bits; bits &= bits - 1) {
+							Box& b = box[__builtin_ctz(bits)];
+							b.minRow = std::min<int>(b.minRow, ur);
+							b.maxRow = std::max<int>(b.maxRow, ur);
+							b.minCol = std::min<int>(b.minCol, uc);
+							b.maxCol = std::max<int>(b.maxCol, uc);
+						}
+					},
+					[&](int u, int v, int dir) { first[v] = via(u, dir); },
+					[&](int u, int v, int dir) { first[v] |= via(u, dir); });
+			}
+	});
+
+	buildTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+bool GoalBounds::write(const std::string& path) const {
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	std::int32_t size[2] = { width(), height() };
+	bool ok = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1 &&
+		std::fwrite(&VERSION, sizeof(VERSION), 1, file) == 1 &&
+		std::fwrite(size, sizeof(size), 1, file) == 1 &&
+		std::fwrite(boxes.data(), 1, boxes.bytes(), file) == boxes.bytes();
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		std::perror(path.c_str());
+	return ok;
+}
+
+bool GoalBounds::read(const std::string& path) {
+	FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	char magic[sizeof(MAGIC)];
+	std::uint32_t version;
+	std::int32_t size[2];
+	bool ok = std::fread(magic, sizeof(magic), 1, file) == 1 && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		std::fread(&version, sizeof(version), 1, file) == 1 && version == VERSION &&
+		std::fread(size, sizeof(size), 1, file) == 1 &&
+		0 <= size[0] && size[0] <= MAXSIDE && 0 <= size[1] && size[1] <= MAXSIDE;
+	if (ok) {
+		boxes.resize(size[1], size[0]);
+		ok = std::fread(boxes.data(), 1, boxes.bytes(), file) == boxes.bytes();
+	}
+	std::fclose(file);
+	if (!ok)
+		std::fprintf(stderr, "%s: not a goal bounds file\n", path.c_str());
+	return ok;
+}
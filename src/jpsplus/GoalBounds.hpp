@@ -0,0 +1,61 @@
+#ifndef GOALBOUNDS_HPP
+#define GOALBOUNDS_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+#include "Grid.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/*
+ * Goal bounding: for every open cell and direction, the bounding box of all
+ * goals that some optimal path from the cell reaches by leaving it in that
+ * direction. A search may skip a direction whose box does not hold its
+ * goal and still find an optimal path. Building the boxes takes a Dijkstra
+ * search from every open cell, so it is an optional, separate stage.
+ *
+ * File format: the magic "JPSBOUND", uint32 version, int32 width and
+ * height, then Box[height][width][8] in direction order, host byte order.
+ */
+class GoalBounds {
+public:
+	/* rows and columns of a box, empty when minRow > maxRow */
+	struct Box {
+		std::uint16_t minRow, maxRow;
+		std::uint16_t minCol, maxCol;
+	};
+	using BoxCell = std::array<Box, DIRCOUNT>;
+
+	static constexpr char MAGIC[8] = { 'J', 'P', 'S', 'B', 'O', 'U', 'N', 'D' };
+	static constexpr std::uint32_t VERSION = 1;
+	/* coordinates have to fit a Box */
+	static constexpr int MAXSIDE = 65535;
+
+	/* uses up to `threads` threads, false if the map is too large */
+	bool build(const BitGrid& walls, int threads);
+	bool write(const std::string& path) const;
+	bool read(const std::string& path);
+
+	inline bool contains(const int& r, const int& c, const int& dir,
+		const int& goalRow, const int& goalCol) const;
+
+	int width() const { return boxes.width(); }
+	int height() const { return boxes.height(); }
+	/* wall-clock time of the last build(), in ms */
+	double getBuildTime() const { return buildTime; }
+
+private:
+	Grid<BoxCell> boxes;
+	double buildTime = 0;
+};
+
+bool GoalBounds::contains(const int& r, const int& c, const int& dir,
+	const int& goalRow, const int& goalCol) const {
+	const Box& box = boxes[r][c][dir];
+	return box.minRow <= goalRow && goalRow <= box.maxRow &&
+		box.minCol <= goalCol && goalCol <= box.maxCol;
+}
+
+#endif /* GOALBOUNDS_HPP */
@@ -0,0 +1,141 @@
+#ifndef GRIDFLOOD_HPP
+#define GRIDFLOOD_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/*
+ * Dijkstra over the open cells of a rectangle of a map at 1 per cardinal
+ * and sqrt(2) per diagonal step, the exact distances the preprocessing
+ * stages build on: goal bounds, the clusters of a hierarchy and landmarks.
+ * The moves allowed from each cell are worked out once per rectangle and
+ * the state of a flood is stamped by generation, so that one flood after
+ * another from many sources touches only the cells each reaches.
+ */
+class GridFlood {
+public:
+	/* moves improving a distance by at most `tolerance` count as ties */
+	explicit GridFlood(double tolerance = 0) : tolerance(tolerance) {}
+
+	/* the open cells of rows [top, bottom) and columns [left, right) of
+	 * `walls`, which paths do not leave; diagonals only between two open
+	 * cardinal neighbours, as in the search */
+	inline void setArea(const BitGrid& walls, int top, int left, int bottom, int right);
+	void setArea(const BitGrid& walls) { setArea(walls, 0, 0, walls.lineCount(), walls.lineLength()); }
+
+	/* cells are numbered row by row within the rectangle */
+	std::size_t size() const { return moves.size(); }
+	int index(const int& row, const int& col) const { return (row - top) * areaWidth + col - left; }
+	int rowOf(const int& cell) const { return top + cell / areaWidth; }
+	int colOf(const int& cell) const { return left + cell % areaWidth; }
+
+	/* distance from the source of the last run(), infinity where it did
+	 * not get */
+	double distance(const int& cell) const {
+		return reached[cell] == generation ? dist[cell] : std::numeric_limits<double>::infinity();
+	}
+
+	/* floods from the open cell `source`, calling settled(u) once u has its
+	 * final distance, improved(u, v, dir) when the move from u in `dir`
+	 * gives v a shorter distance, and tied(u, v, dir) when it gives a cell
+	 * not settled yet the same distance, within the tolerance */
+	template<typename Settled, typename Improved, typename Tied>
+	void run(int source, Settled settled, Improved improved, Tied tied);
+	void run(int source) {
+		run(source, [](int) {}, [](int, int, int) {}, [](int, int, int) {});
+	}
+
+private:
+	double tolerance;
+	int top = 0;
+	int left = 0;
+	int areaWidth = 0;
+	std::vector<std::uint8_t> moves;
+	int offset[DIRCOUNT] = {};
+	double cost[DIRCOUNT] = {};
+
+	std::vector<double> dist;
+	std::vector<std::uint32_t> reached;
+	std::vector<std::uint32_t> closed;
+	std::vector<std::pair<double, int>> heap;
+	std::uint32_t generation = 0;
+};
+
+void GridFlood::setArea(const BitGrid& walls, int top, int left, int bottom, int right) {
+	this->top = top;
+	this->left = left;
+	areaWidth = right - left;
+	auto inside = [&](int r, int c) {
+		return top <= r && r < bottom && left <= c && c < right && !walls.get(r, c);
+	};
+	const std::size_t cellCount = static_cast<std::size_t>(bottom - top) * areaWidth;
+	moves.assign(cellCount, 0);
+	for (int r = top; r < bottom; ++r)
+		for (int c = left; c < right; ++c) {
+			if (!inside(r, c))
+				continue;
+			std::uint8_t mask = 0;
+			for (int dir = 0; dir < DIRCOUNT; ++dir)
+				if (inside(r + drow[dir], c + dcol[dir]) && (isCardinal(static_cast<direction>(dir)) ||
+					(inside(r + drow[dir], c) && inside(r, c + dcol[dir]))))
+					mask |= 1 << dir;
+			moves[index(r, c)] = mask;
+		}
+	for (int dir = 0; dir < DIRCOUNT; ++dir) {
+		offset[dir] = drow[dir] * areaWidth + dcol[dir];
+		cost[dir] = isCardinal(static_cast<direction>(dir)) ? 1 : std::sqrt(2.0);
+	}
+
+	dist.resize(cellCount);
+	reached.assign(cellCount, 0);
+	closed.assign(cellCount, 0);
+	generation = 0;
+}
+
+template<typename Settled, typename Improved, typename Tied>
+void GridFlood::run(int source, Settled settled, Improved improved, Tied tied) {
+	if (++generation == 0) {
+		std::fill(reached.begin(), reached.end(), 0);
+		std::fill(closed.begin(), closed.end(), 0);
+		generation = 1;
+	}
+	auto later = [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+		return a.first > b.first;
+	};
+	dist[source] = 0;
+	reached[source] = generation;
+	heap.assign(1, { 0.0, source });
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), later);
+		auto [d, u] = heap.back();
+		heap.pop_back();
+		if (closed[u] == generation)
+			continue;
+		closed[u] = generation;
+		settled(u);
+
+		for (unsigned bits = moves[u]; bits; bits &= bits - 1) {
+			int dir = __builtin_ctz(bits);
+			int v = u + offset[dir];
+			double w = d + cost[dir];
+			if (reached[v] != generation || w < dist[v] - tolerance) {
+				reached[v] = generation;
+				dist[v] = w;
+				improved(u, v, dir);
+				heap.push_back({ w, v });
+				std::push_heap(heap.begin(), heap.end(), later);
+			}
+			else if (closed[v] != generation && w <= dist[v] + tolerance)
+				tied(u, v, dir);
+		}
+	}
+}
+
+#endif /* GRIDFLOOD_HPP */
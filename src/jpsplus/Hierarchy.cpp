@@ -0,0 +1,295 @@
+#include "Hierarchy.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/* entrances from this many cells on are crossed at both ends */
+constexpr int LONG_ENTRANCE = 6;
+
+double octile(const Hierarchy::Cell& a, const Hierarchy::Cell& b) {
+	int dr = std::abs(a.row - b.row);
+	int dc = std::abs(a.col - b.col);
+	return std::max(dr, dc) + (std::sqrt(2.0) - 1) * std::min(dr, dc);
+}
+
+}
+
+bool Hierarchy::build(const BitGrid& walls, int clusterSize, int threads) {
+	auto start = std::chrono::steady_clock::now();
+	if (clusterSize < 2) {
+		std::fprintf(stderr, "clusters need at least 2x2 cells\n");
+		return false;
+	}
+	this->walls = walls;
+	this->clusterSize = clusterSize;
+	const int height = this->height();
+	const int width = this->width();
+	clusterRows = (height + clusterSize - 1) / clusterSize;
+	clusterCols = (width + clusterSize - 1) / clusterSize;
+	const int clusters = clusterRows * clusterCols;
+
+	/* the two cells of every crossing, as row * width + col */
+	std::vector<std::pair<int, int>> crossings;
+	auto addRun = [&](int first, int last, const std::function<std::pair<int, int>(int)>& cells) {
+		if (last - first + 1 < LONG_ENTRANCE)
+			crossings.push_back(cells((first + last) / 2));
+		else {
+			crossings.push_back(cells(first));
+			crossings.push_back(cells(last));
+		}
+	};
+	/* runs along one border, split where the clusters beside it change */
+	auto scanBorder = [&](int length, const std::function<bool(int)>& openAt,
+		const std::function<std::pair<int, int>(int)>& cells) {
+		int first = -1;
+		for (int p = 0; p <= length; ++p) {
+			bool inRun = p < length && openAt(p) && (first == -1 || p % clusterSize != 0);
+			if (first != -1 && !inRun) {
+				addRun(first, p - 1, cells);
+				first = -1;
+			}
+			if (p < length && openAt(p) && first == -1)
+				first = p;
+		}
+	};
+	for (int x = clusterSize - 1; x + 1 < width; x += clusterSize)
+		scanBorder(height, [&](int r) { return open(r, x) && open(r, x + 1); },
+			[&](int r) { return std::make_pair(r * width + x, r * width + x + 1); });
+	for (int y = clusterSize - 1; y + 1 < height; y += clusterSize)
+		scanBorder(width, [&](int c) { return open(y, c) && open(y + 1, c); },
+			[&](int c) { return std::make_pair(y * width + c, (y + 1) * width + c); });
+
+	/* nodes sorted by cluster, then by cell */
+	const long long cellCount = static_cast<long long>(width) * height;
+	auto key = [&](int cell) { return clusterOf(cell / width, cell % width) * cellCount + cell; };
+	std::vector<long long> keys;
+	keys.reserve(2 * crossings.size());
+	for (const auto& crossing : crossings) {
+		keys.push_back(key(crossing.first));
+		keys.push_back(key(crossing.second));
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	auto nodeOf = [&](int cell) {
+		return static_cast<int>(std::lower_bound(keys.begin(), keys.end(), key(cell)) - keys.begin());
+	};
+
+	nodes.resize(keys.size());
+	clusterFirst.assign(clusters + 1, 0);
+	for (std::size_t n = 0; n < keys.size(); ++n) {
+		int cell = static_cast<int>(keys[n] % cellCount);
+		nodes[n] = { cell / width, cell % width };
+		++clusterFirst[keys[n] / cellCount + 1];
+	}
+	for (int k = 0; k < clusters; ++k)
+		clusterFirst[k + 1] += clusterFirst[k];
+
+	std::vector<std::vector<Edge>> adjacent(nodes.size());
+	for (const auto& crossing : crossings) {
+		int a = nodeOf(crossing.first), b = nodeOf(crossing.second);
+		adjacent[a].push_back({ b, 1 });
+		adjacent[b].push_back({ a, 1 });
+	}
+
+	/* every node of a cluster to every other one it reaches inside it;
+	 * clusters are handed out one at a time */
+	std::atomic<int> nextCluster(0);
+	parallelRun(std::max(1, threads), [&](int) {
+		Search search;
+		for (int k; (k = nextCluster++) < clusters;)
+			for (int n = clusterFirst[k]; n < clusterFirst[k + 1]; ++n) {
+				flood(search, k, nodes[n].row, nodes[n].col);
+				for (int m = clusterFirst[k]; m < clusterFirst[k + 1]; ++m) {
+					double d = floodDistance(search, nodes[m]);
+					if (m != n && d < INF)
+						adjacent[n].push_back({ m, static_cast<float>(d) });
+				}
+			}
+	});
+
+	firstEdge.assign(1, 0);
+	edges.clear();
+	for (const auto& list : adjacent) {
+		edges.insert(edges.end(), list.begin(), list.end());
+		firstEdge.push_back(static_cast<std::int32_t>(edges.size()));
+	}
+
+	buildTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+void Hierarchy::flood(Search& search, int cluster, int row, int col) const {
+	if (search.floodOf != this || search.floodCluster != cluster) {
+		const int top = cluster / clusterCols * clusterSize;
+		const int left = cluster % clusterCols * clusterSize;
+		search.flood.setArea(walls, top, left, std::min(top + clusterSize, height()),
+			std::min(left + clusterSize, width()));
+		search.floodOf = this;
+		search.floodCluster = cluster;
+	}
+	search.flood.run(search.flood.index(row, col));
+}
+
+bool Hierarchy::findPath(Search& search, const Cell& start, const Cell& goal,
+	std::vector<Cell>& waypoints, double& pathCost) const {
+	const int count = static_cast<int>(nodes.size());
+	const int startNode = count, goalNode = count + 1;
+	if (search.cost.size() != nodes.size() + 2) {
+		search.cost.assign(count + 2, 0);
+		search.parent.assign(count + 2, -1);
+		search.stamp.assign(count + 2, 0);
+		search.toGoal.assign(count, 0);
+		search.goalStamp.assign(count, 0);
+		search.generation = 0;
+	}
+	if (++search.generation == 0) {
+		std::fill(search.stamp.begin(), search.stamp.end(), 0);
+		std::fill(search.goalStamp.begin(), search.goalStamp.end(), 0);
+		search.generation = 1;
+	}
+	const std::uint32_t generation = search.generation;
+	search.expansions = 0;
+	waypoints.clear();
+
+	/* start and goal join the nodes of their clusters they reach inside */
+	int cluster = clusterOf(start.row, start.col);
+	flood(search, cluster, start.row, start.col);
+	search.fromStart.clear();
+	for (int n = clusterFirst[cluster]; n < clusterFirst[cluster + 1]; ++n) {
+		double d = floodDistance(search, nodes[n]);
+		if (d < INF)
+			search.fromStart.push_back({ n, static_cast<float>(d) });
+	}
+	cluster = clusterOf(goal.row, goal.col);
+	flood(search, cluster, goal.row, goal.col);
+	for (int n = clusterFirst[cluster]; n < clusterFirst[cluster + 1]; ++n) {
+		double d = floodDistance(search, nodes[n]);
+		if (d < INF) {
+			search.toGoal[n] = d;
+			search.goalStamp[n] = generation;
+		}
+	}
+
+	auto cellOf = [&](int n) { return n < count ? nodes[n] : n == startNode ? start : goal; };
+	auto later = [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+		return a.first > b.first;
+	};
+	auto relax = [&](int to, double cost, int from) {
+		if (search.stamp[to] == generation && !(cost < search.cost[to]))
+			return;
+		search.stamp[to] = generation;
+		search.cost[to] = cost;
+		search.parent[to] = from;
+		search.heap.push_back({ cost + octile(cellOf(to), goal), to });
+		std::push_heap(search.heap.begin(), search.heap.end(), later);
+	};
+
+	search.heap.clear();
+	relax(startNode, 0, -1);
+	while (!search.heap.empty()) {
+		std::pop_heap(search.heap.begin(), search.heap.end(), later);
+		auto [f, u] = search.heap.back();
+		search.heap.pop_back();
+		/* a later push lowered its cost */
+		if (f > search.cost[u] + octile(cellOf(u), goal) + 1e-9)
+			continue;
+		if (u == goalNode) {
+			for (int n = goalNode; n != -1; n = search.parent[n])
+				waypoints.push_back(cellOf(n));
+			std::reverse(waypoints.begin(), waypoints.end());
+			pathCost = search.cost[goalNode];
+			return true;
+		}
+		++search.expansions;
+
+		double cost = search.cost[u];
+		if (u == startNode) {
+			for (const Edge& edge : search.fromStart)
+				relax(edge.to, edge.cost, u);
+			continue;
+		}
+		for (int e = firstEdge[u]; e < firstEdge[u + 1]; ++e)
+			relax(edges[e].to, cost + edges[e].cost, u);
+		if (search.goalStamp[u] == generation)
+			relax(goalNode, cost + search.toGoal[u], u);
+	}
+	return false;
+}
+
+bool Hierarchy::write(const std::string& path) const {
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	std::int32_t size[3] = { width(), height(), clusterSize };
+	std::int32_t counts[2] = { static_cast<std::int32_t>(nodes.size()), static_cast<std::int32_t>(edges.size()) };
+	bool ok = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1 &&
+		std::fwrite(&VERSION, sizeof(VERSION), 1, file) == 1 &&
+		std::fwrite(size, sizeof(size), 1, file) == 1;
+	for (int r = 0; ok && r < height(); ++r)
+		ok = std::fwrite(walls.line(r), sizeof(BitGrid::word), walls.wordsPerLine(), file) ==
+			static_cast<std::size_t>(walls.wordsPerLine());
+	ok = ok && std::fwrite(counts, sizeof(counts), 1, file) == 1 &&
+		std::fwrite(nodes.data(), sizeof(Cell), nodes.size(), file) == nodes.size() &&
+		std::fwrite(firstEdge.data(), sizeof(std::int32_t), firstEdge.size(), file) == firstEdge.size() &&
+		std::fwrite(edges.data(), sizeof(Edge), edges.size(), file) == edges.size() &&
+		std::fwrite(clusterFirst.data(), sizeof(std::int32_t), clusterFirst.size(), file) == clusterFirst.size();
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		std::perror(path.c_str());
+	return ok;
+}
+
+bool Hierarchy::read(const std::string& path) {
+	FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	char magic[sizeof(MAGIC)];
+	std::uint32_t version;
+	std::int32_t size[3];
+	std::int32_t counts[2];
+	bool ok = std::fread(magic, sizeof(magic), 1, file) == 1 && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		std::fread(&version, sizeof(version), 1, file) == 1 && version == VERSION &&
+		std::fread(size, sizeof(size), 1, file) == 1 &&
+		size[0] >= 0 && size[1] >= 0 && size[2] >= 2;
+	if (ok) {
+		walls.resize(size[1], size[0]);
+		clusterSize = size[2];
+		clusterRows = (size[1] + clusterSize - 1) / clusterSize;
+		clusterCols = (size[0] + clusterSize - 1) / clusterSize;
+		for (int r = 0; ok && r < size[1]; ++r)
+			ok = std::fread(walls.line(r), sizeof(BitGrid::word), walls.wordsPerLine(), file) ==
+				static_cast<std::size_t>(walls.wordsPerLine());
+		ok = ok && std::fread(counts, sizeof(counts), 1, file) == 1 && counts[0] >= 0 && counts[1] >= 0;
+	}
+	if (ok) {
+		nodes.resize(counts[0]);
+		firstEdge.resize(counts[0] + 1);
+		edges.resize(counts[1]);
+		clusterFirst.resize(clusterRows * clusterCols + 1);
+		ok = std::fread(nodes.data(), sizeof(Cell), nodes.size(), file) == nodes.size() &&
+			std::fread(firstEdge.data(), sizeof(std::int32_t), firstEdge.size(), file) == firstEdge.size() &&
+			std::fread(edges.data(), sizeof(Edge), edges.size(), file) == edges.size() &&
+			std::fread(clusterFirst.data(), sizeof(std::int32_t), clusterFirst.size(), file) == clusterFirst.size() &&
+			firstEdge.back() == counts[1] && clusterFirst.back() == counts[0];
+	}
+	std::fclose(file);
+	if (!ok)
+		std::fprintf(stderr, "%s: not a hierarchy file\n", path.c_str());
+	return ok;
+}
@@ -0,0 +1,122 @@
+#ifndef HIERARCHY_HPP
+#define HIERARCHY_HPP
+
+#include "BitGrid.hpp"
+#include "GridFlood.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Two-level abstraction of a map for long queries, after HPA*. The map is
+ * cut into square clusters; every run of open cells along the border of two
+ * clusters, open on both sides, becomes an entrance, crossed in its middle
+ * or, from six cells on, at both ends. The cells on either side of an
+ * entrance are the nodes of an abstract graph, whose edges cross a border
+ * in one step or join two nodes of a cluster at the cost of the shortest
+ * path inside it. A query links start and goal to the nodes of their own
+ * clusters and searches the abstract graph; Runtime refines the result
+ * with JPS+ (see Runtime::setHierarchy()).
+ *
+ * File format: the magic "JPSHIERA", uint32 version, int32 width, height
+ * and cluster size, the walls as BitGrid words line by line, int32 node
+ * and edge counts, Node[nodes], int32 firstEdge[nodes + 1], Edge[edges] and
+ * int32 clusterFirst[clusters + 1], host byte order.
+ */
+class Hierarchy {
+public:
+	struct Cell {
+		int row, col;
+	};
+	struct Edge {
+		std::int32_t to;
+		/* in steps, 1 per cardinal and sqrt(2) per diagonal step; only
+		 * guides the refinement, so single precision will do */
+		float cost;
+	};
+
+	/* search state of one thread, kept across queries */
+	class Search {
+	private:
+		friend class Hierarchy;
+		/* shortest paths inside one cluster, kept for the next flood */
+		GridFlood flood;
+		const Hierarchy* floodOf = nullptr;
+		int floodCluster = -1;
+		std::vector<std::pair<double, int>> heap;
+		/* the abstract graph, with start and goal as the last two nodes */
+		std::vector<double> cost;
+		std::vector<std::int32_t> parent;
+		std::vector<std::uint32_t> stamp;
+		std::vector<double> toGoal;
+		std::vector<std::uint32_t> goalStamp;
+		std::vector<Edge> fromStart;
+		std::uint32_t generation = 0;
+		long expansions = 0;
+	};
+
+	static constexpr char MAGIC[8] = { 'J', 'P', 'S', 'H', 'I', 'E', 'R', 'A' };
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr int DEFAULT_CLUSTER = 32;
+
+	/* clusters of `clusterSize` squared cells, built with up to `threads`
+	 * threads; false for a cluster size below 2 */
+	bool build(const BitGrid& walls, int clusterSize, int threads);
+	bool write(const std::string& path) const;
+	bool read(const std::string& path);
+
+	int width() const { return walls.lineLength(); }
+	int height() const { return walls.lineCount(); }
+	int getClusterSize() const { return clusterSize; }
+	std::size_t nodeCount() const { return nodes.size(); }
+	std::size_t edgeCount() const { return edges.size(); }
+	/* wall-clock time of the last build(), in ms */
+	double getBuildTime() const { return buildTime; }
+
+	inline int clusterOf(const int& row, const int& col) const;
+
+	/* the abstract path from start to goal, as the cells from start to goal
+	 * in `waypoints`, and its cost; false if the goal cannot be reached.
+	 * Start and goal have to be open cells of different clusters */
+	bool findPath(Search& search, const Cell& start, const Cell& goal,
+		std::vector<Cell>& waypoints, double& cost) const;
+	/* abstract nodes expanded by the last findPath() */
+	long getExpansions(const Search& search) const { return search.expansions; }
+
+private:
+	inline bool open(const int& r, const int& c) const;
+	/* shortest distances inside `cluster` from (row, col), left in
+	 * search.flood */
+	void flood(Search& search, int cluster, int row, int col) const;
+	/* search.flood.distance() of the cell, infinity where unreachable */
+	inline double floodDistance(const Search& search, const Cell& cell) const;
+
+private:
+	BitGrid walls;
+	int clusterSize = 0;
+	int clusterRows = 0;
+	int clusterCols = 0;
+	/* nodes of cluster k are clusterFirst[k] .. clusterFirst[k + 1] - 1,
+	 * edges of node n firstEdge[n] .. firstEdge[n + 1] - 1 */
+	std::vector<Cell> nodes;
+	std::vector<std::int32_t> clusterFirst;
+	std::vector<std::int32_t> firstEdge;
+	std::vector<Edge> edges;
+	double buildTime = 0;
+};
+
+bool Hierarchy::open(const int& r, const int& c) const {
+	return 0 <= r && r < height() && 0 <= c && c < width() && !walls.get(r, c);
+}
+
+int Hierarchy::clusterOf(const int& row, const int& col) const {
+	return row / clusterSize * clusterCols + col / clusterSize;
+}
+
+double Hierarchy::floodDistance(const Search& search, const Cell& cell) const {
+	return search.flood.distance(search.flood.index(cell.row, cell.col));
+}
+
+#endif /* HIERARCHY_HPP */
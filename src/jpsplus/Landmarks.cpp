@@ -0,0 +1,168 @@
+#include "Landmarks.hpp"
+#include "GridFlood.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+bool Landmarks::build(const BitGrid& walls, int count) {
+	auto start = std::chrono::steady_clock::now();
+	const int height = walls.lineCount();
+	const int width = walls.lineLength();
+	if (count < 1) {
+		std::fprintf(stderr, "at least one landmark is needed\n");
+		return false;
+	}
+
+	const std::size_t cellCount = static_cast<std::size_t>(height) * width;
+	GridFlood flood;
+	flood.setArea(walls);
+
+	/* the connected parts of the map, each labelled by a flood from its
+	 * first open cell */
+	struct Part {
+		int first;
+		int size;
+		int quota;
+	};
+	std::vector<Part> parts;
+	std::vector<int> partOf(cellCount, -1);
+	for (std::size_t i = 0; i < cellCount; ++i) {
+		if (partOf[i] != -1 || walls.get(flood.rowOf(i), flood.colOf(i)))
+			continue;
+		const int p = static_cast<int>(parts.size());
+		Part part = { static_cast<int>(i), 0, 0 };
+		flood.run(part.first, [&](int u) { partOf[u] = p; ++part.size; },
+			[](int, int, int) {}, [](int, int, int) {});
+		parts.push_back(part);
+	}
+	std::vector<int> order(parts.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return parts[a].size > parts[b].size; });
+
+	/* landmarks go to the largest part, and to another one only while it
+	 * has more cells per landmark (D'Hondt), so that pockets cut off from
+	 * the rest take none from it; a single cell has no use for one */
+	for (int k = 0; k < count; ++k) {
+		Part* best = nullptr;
+		for (int p : order) {
+			Part& part = parts[p];
+			if (part.size > 1 && part.quota < part.size && (!best ||
+				static_cast<double>(part.size) / (part.quota + 1) > static_cast<double>(best->size) / (best->quota + 1)))
+				best = &part;
+		}
+		if (!best)
+			break;
+		++best->quota;
+	}
+
+	landmarks.clear();
+	mapWidth = width;
+	/* the landmarks of a cell side by side, read together by bound() */
+	landmarkCount = count;
+	distances.resize(height, width * count);
+	/* farthest first within each part: the distance of its cells from
+	 * their nearest landmark so far, always finite */
+	std::vector<double> nearest(cellCount, std::numeric_limits<double>::infinity());
+	for (int p : order) {
+		if (!parts[p].quota)
+			continue;
+		/* the first landmark of a part from its first open cell */
+		flood.run(parts[p].first);
+		for (int picked = 0; picked < parts[p].quota; ++picked) {
+			int next = -1;
+			double farthest = 0;
+			for (std::size_t i = 0; i < cellCount; ++i) {
+				if (partOf[i] != p)
+					continue;
+				double d = picked ? nearest[i] : flood.distance(i);
+				if (d > farthest) {
+					next = static_cast<int>(i);
+					farthest = d;
+				}
+			}
+			if (next == -1)
+				break;
+			int k = static_cast<int>(landmarks.size());
+			landmarks.push_back({ flood.rowOf(next), flood.colOf(next) });
+			flood.run(next);
+			for (std::size_t i = 0; i < cellCount; ++i) {
+				if (partOf[i] == p)
+					nearest[i] = std::min(nearest[i], flood.distance(i));
+				distances.data()[i * count + k] = static_cast<float>(flood.distance(i));
+			}
+		}
+	}
+
+	/* a map whose parts have too few cells for `count` landmarks */
+	if (static_cast<int>(landmarks.size()) < count) {
+		Grid<float> packed(height, width * static_cast<int>(landmarks.size()));
+		landmarkCount = static_cast<int>(landmarks.size());
+		for (std::size_t i = 0; i < cellCount; ++i)
+			for (int k = 0; k < landmarkCount; ++k)
+				packed.data()[i * landmarkCount + k] = distances.data()[i * count + k];
+		distances = packed;
+	}
+
+	buildTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+bool Landmarks::write(const std::string& path) const {
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	std::int32_t size[3] = { width(), height(), landmarkCount };
+	std::vector<std::int32_t> cells;
+	for (const Cell& cell : landmarks) {
+		cells.push_back(cell.row);
+		cells.push_back(cell.col);
+	}
+	bool ok = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1 &&
+		std::fwrite(&VERSION, sizeof(VERSION), 1, file) == 1 &&
+		std::fwrite(size, sizeof(size), 1, file) == 1 &&
+		std::fwrite(cells.data(), sizeof(std::int32_t), cells.size(), file) == cells.size() &&
+		std::fwrite(distances.data(), 1, distances.bytes(), file) == distances.bytes();
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		std::perror(path.c_str());
+	return ok;
+}
+
+bool Landmarks::read(const std::string& path) {
+	FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		std::perror(path.c_str());
+		return false;
+	}
+	char magic[sizeof(MAGIC)];
+	std::uint32_t version;
+	std::int32_t size[3];
+	bool ok = std::fread(magic, sizeof(magic), 1, file) == 1 && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		std::fread(&version, sizeof(version), 1, file) == 1 && version == VERSION &&
+		std::fread(size, sizeof(size), 1, file) == 1 &&
+		size[0] >= 0 && size[1] >= 0 && size[2] >= 0;
+	if (ok) {
+		std::vector<std::int32_t> cells(2 * size[2]);
+		ok = std::fread(cells.data(), sizeof(std::int32_t), cells.size(), file) == cells.size();
+		landmarks.clear();
+		for (int k = 0; ok && k < size[2]; ++k)
+			landmarks.push_back({ cells[2 * k], cells[2 * k + 1] });
+	}
+	if (ok) {
+		mapWidth = size[0];
+		landmarkCount = size[2];
+		distances.resize(size[1], size[0] * size[2]);
+		ok = std::fread(distances.data(), 1, distances.bytes(), file) == distances.bytes();
+	}
+	std::fclose(file);
+	if (!ok)
+		std::fprintf(stderr, "%s: not a landmarks file\n", path.c_str());
+	return ok;
+}
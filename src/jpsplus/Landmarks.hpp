@@ -0,0 +1,81 @@
+#ifndef LANDMARKS_HPP
+#define LANDMARKS_HPP
+
+#include "BitGrid.hpp"
+#include "Grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Landmarks for the ALT heuristic: exact distances from a few open cells to
+ * every cell. By the triangle inequality |d(L, n) - d(L, g)| is a lower
+ * bound on the distance from n to g for every landmark L, often far better
+ * than octile distance on maps of corridors and dead ends, but says
+ * nothing between cells a landmark does not reach. Landmarks are shared
+ * out among the connected parts of the map by size, so that pockets cut
+ * off from the rest get none unless the count allows, and picked farthest
+ * first within a part: each new one is the cell farthest from those so
+ * far, the first one the cell farthest from the part's first open cell.
+ *
+ * File format: the magic "JPSLANDM", uint32 version, int32 width, height
+ * and landmark count, int32 row and col of every landmark, then
+ * float[height][width][count], host byte order.
+ */
+class Landmarks {
+public:
+	struct Cell {
+		int row, col;
+	};
+
+	static constexpr char MAGIC[8] = { 'J', 'P', 'S', 'L', 'A', 'N', 'D', 'M' };
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr int DEFAULT_COUNT = 8;
+
+	/* `count` landmarks at most, fewer where the parts of the map are too
+	 * small to hold them */
+	bool build(const BitGrid& walls, int count);
+	bool write(const std::string& path) const;
+	bool read(const std::string& path);
+
+	int width() const { return mapWidth; }
+	int height() const { return distances.height(); }
+	int count() const { return landmarkCount; }
+	const std::vector<Cell>& cells() const { return landmarks; }
+	/* bytes of distances per landmark */
+	std::size_t bytesPerLandmark() const { return static_cast<std::size_t>(mapWidth) * height() * sizeof(float); }
+	/* wall-clock time of the last build(), in ms */
+	double getBuildTime() const { return buildTime; }
+
+	/* the distances of a cell from every landmark, infinity where it is
+	 * not reachable */
+	const float* at(const int& row, const int& col) const { return distances[row] + col * landmarkCount; }
+	/* lower bound on the distance between the cells of `from` and `to`,
+	 * both taken from at() */
+	inline double bound(const float* from, const float* to) const;
+
+private:
+	Grid<float> distances;
+	int mapWidth = 0;
+	int landmarkCount = 0;
+	std::vector<Cell> landmarks;
+	double buildTime = 0;
+};
+
+/* distances are stored as floats; taking off twice their rounding error
+ * keeps the bound below the exact one */
+double Landmarks::bound(const float* from, const float* to) const {
+	double best = 0;
+	for (int k = 0; k < landmarkCount; ++k) {
+		double a = from[k], b = to[k];
+		if (std::isinf(a) || std::isinf(b))
+			continue;
+		best = std::max(best, std::fabs(a - b) - (a + b) * 0x1p-23);
+	}
+	return best;
+}
+
+#endif /* LANDMARKS_HPP */
@@ -0,0 +1,219 @@
+#ifndef OPENLIST_HPP
+#define OPENLIST_HPP
+
+#include "Grid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Open lists for the search loop, all with the same interface: resize() to
+ * the map once, clear() before every search, push() a node (inserting it,
+ * or lowering its key if the list can), pop() the first node, size()
+ * counting stale entries too. Nodes need
+ * row, col, sortCost and before(), which orders them by sortCost and
+ * possibly ties; lists that keep duplicates leave skipping stale entries
+ * to the caller.
+ */
+
+/*
+ * Binary heap with lazy duplicates, the original std::priority_queue
+ * (same push_heap/pop_heap calls and Node::operator<, so ties break the
+ * same way and the text output does not change).
+ */
+template<typename Node>
+class BinaryHeap {
+public:
+	void resize(int, int) {}
+	void clear() { heap.clear(); }
+	bool empty() const { return heap.empty(); }
+	std::size_t size() const { return heap.size(); }
+	std::size_t capacity() const { return heap.capacity(); }
+
+	void push(const Node& node) {
+		heap.push_back(node);
+		std::push_heap(heap.begin(), heap.end());
+	}
+
+	Node pop() {
+		std::pop_heap(heap.begin(), heap.end());
+		Node top = heap.back();
+		heap.pop_back();
+		return top;
+	}
+
+private:
+	std::vector<Node> heap;
+};
+
+/*
+ * 4-ary heap indexed by cell: every cell is in the heap at most once and an
+ * improved path lowers its key in place, so there are no stale entries and
+ * the heap stays as small as the frontier. A 4-ary heap is half as deep as
+ * a binary one and its children share a cache line.
+ */
+template<typename Node>
+class IndexedHeap {
+public:
+	static constexpr std::size_t ARITY = 4;
+
+	/* the positions are only allocated by the first clear(), so that a
+	 * Runtime searching with another open list does without them */
+	void resize(int height, int width) {
+		mapHeight = height;
+		mapWidth = width;
+		position = Grid<int>();
+		heap.clear();
+	}
+
+	/* only the cells still in the heap have a position to reset */
+	void clear() {
+		if (position.size() != static_cast<std::size_t>(mapHeight) * mapWidth)
+			position.resize(mapHeight, mapWidth);
+		for (const Node& node : heap)
+			position[node.row][node.col] = 0;
+		heap.clear();
+	}
+
+	bool empty() const { return heap.empty(); }
+	std::size_t size() const { return heap.size(); }
+
+	void push(const Node& node) {
+		int& pos = position[node.row][node.col];
+		if (pos) {
+			std::size_t i = pos - 1;
+			if (!node.before(heap[i]))
+				return;
+			heap[i] = node;
+			siftUp(i);
+		}
+		else {
+			heap.push_back(node);
+			siftUp(heap.size() - 1);
+		}
+	}
+
+	Node pop() {
+		assert(!heap.empty());
+		Node top = heap.front();
+		position[top.row][top.col] = 0;
+		Node last = heap.back();
+		heap.pop_back();
+		if (!heap.empty()) {
+			heap.front() = last;
+			siftDown(0);
+		}
+		return top;
+	}
+
+private:
+	void place(std::size_t i, const Node& node) {
+		heap[i] = node;
+		position[node.row][node.col] = i + 1;
+	}
+
+	void siftUp(std::size_t i) {
+		Node node = heap[i];
+		while (i > 0) {
+			std::size_t parent = (i - 1) / ARITY;
+			if (!node.before(heap[parent]))
+				break;
+			place(i, heap[parent]);
+			i = parent;
+		}
+		place(i, node);
+	}
+
+	void siftDown(std::size_t i) {
+		Node node = heap[i];
+		for (;;) {
+			std::size_t first = i * ARITY + 1;
+			if (first >= heap.size())
+				break;
+			std::size_t best = first;
+			std::size_t last = std::min(first + ARITY, heap.size());
+			for (std::size_t c = first + 1; c < last; ++c)
+				if (heap[c].before(heap[best]))
+					best = c;
+			if (!heap[best].before(node))
+				break;
+			place(i, heap[best]);
+			i = best;
+		}
+		place(i, node);
+	}
+
+private:
+	std::vector<Node> heap;
+	/* heap index + 1, 0 when the cell is not in the heap */
+	Grid<int> position;
+	int mapHeight = 0;
+	int mapWidth = 0;
+};
+
+/*
+ * Buckets of sortCost quantized to `width`, with lazy duplicates. f never
+ * decreases along a search with a consistent heuristic, so pop() only moves
+ * a cursor forward over empty buckets; within the current bucket it takes
+ * the first node, which keeps the order (and the costs) exact, and of
+ * equal ones the latest pushed, so ties go depth first.
+ */
+template<typename Node>
+class BucketQueue {
+public:
+	explicit BucketQueue(double width = 0.0625) : width(width) {}
+
+	void resize(int, int) {}
+	/* a new bucket width, in sortCost units, for the following searches */
+	void setWidth(double width) {
+		clear();
+		this->width = width;
+	}
+
+	void clear() {
+		for (std::size_t b = cursor; b < used; ++b)
+			buckets[b].clear();
+		cursor = used = 0;
+		count = 0;
+	}
+
+	bool empty() const { return count == 0; }
+	std::size_t size() const { return count; }
+
+	void push(const Node& node) {
+		std::size_t b = static_cast<std::size_t>(node.sortCost / width);
+		if (b >= buckets.size())
+			buckets.resize(b + 1);
+		buckets[b].push_back(node);
+		if (count++ == 0 || b < cursor)
+			cursor = b;
+		used = std::max(used, b + 1);
+	}
+
+	Node pop() {
+		assert(count > 0);
+		while (buckets[cursor].empty())
+			++cursor;
+		std::vector<Node>& bucket = buckets[cursor];
+		std::size_t best = bucket.size() - 1;
+		for (std::size_t i = best; i-- > 0;)
+			if (bucket[i].before(bucket[best]))
+				best = i;
+		Node top = bucket[best];
+		bucket.erase(bucket.begin() + best);
+		--count;
+		return top;
+	}
+
+private:
+	double width;
+	std::vector<std::vector<Node>> buckets;
+	/* buckets below cursor are empty, buckets from used on were never filled */
+	std::size_t cursor = 0;
+	std::size_t used = 0;
+	std::size_t count = 0;
+};
+
+#endif /* OPENLIST_HPP */
@@ -0,0 +1,106 @@
+#ifndef OVERLAY_HPP
+#define OVERLAY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+ * Cells blocked for the time being on top of a preprocessed map, units
+ * standing in a corridor say, searched around without a new distance table
+ * (see Runtime::setOverlay()). Blocking or unblocking a cell is O(1) and
+ * lock-free, so it may happen while other threads search: a query sees
+ * every change made before it started, and cells changed while it runs
+ * either way.
+ *
+ * Whether a cell is a jump point depends only on the 3x3 block around it,
+ * so next to the blocked cells near() counts those in that block, and
+ * rowNear() and colNear() sum it over a row or a column: the table holds
+ * wherever near() is 0, and along whole rows and columns where the sum is.
+ */
+class Overlay {
+public:
+	Overlay() = default;
+	Overlay(int height, int width) { resize(height, width); }
+
+	/* every cell open again; not while queries run */
+	void resize(int height, int width);
+
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+
+	/* false if nothing changed */
+	bool block(int row, int col) { return change(row, col, true); }
+	bool unblock(int row, int col) { return change(row, col, false); }
+
+	inline bool blocked(const int& row, const int& col) const;
+	std::size_t blockedCount() const { return count.load(std::memory_order_acquire); }
+	/* blocked cells in the 3x3 block around a cell and summed over a line */
+	int near(const int& row, const int& col) const {
+		return nearCells[static_cast<std::size_t>(row) * mapWidth + col].load(std::memory_order_relaxed);
+	}
+	std::uint32_t rowNear(const int& row) const { return rows[row].load(std::memory_order_relaxed); }
+	std::uint32_t colNear(const int& col) const { return cols[col].load(std::memory_order_relaxed); }
+
+private:
+	bool change(int row, int col, bool block);
+
+private:
+	static constexpr int WORDBITS = 64;
+
+	int mapWidth = 0;
+	int mapHeight = 0;
+	int wordsPerRow = 0;
+	std::unique_ptr<std::atomic<std::uint64_t>[]> bits;
+	std::unique_ptr<std::atomic<std::uint8_t>[]> nearCells;
+	std::unique_ptr<std::atomic<std::uint32_t>[]> rows;
+	std::unique_ptr<std::atomic<std::uint32_t>[]> cols;
+	std::atomic<std::size_t> count{0};
+};
+
+inline void Overlay::resize(int height, int width) {
+	mapWidth = width;
+	mapHeight = height;
+	wordsPerRow = (width + WORDBITS - 1) / WORDBITS;
+	std::size_t cells = static_cast<std::size_t>(height) * width;
+	/* value-initialised, all zero */
+	bits.reset(new std::atomic<std::uint64_t>[static_cast<std::size_t>(height) * wordsPerRow]());
+	nearCells.reset(new std::atomic<std::uint8_t>[cells]());
+	rows.reset(new std::atomic<std::uint32_t>[height]());
+	cols.reset(new std::atomic<std::uint32_t>[width]());
+	count.store(0, std::memory_order_release);
+}
+
+bool Overlay::blocked(const int& row, const int& col) const {
+	return bits[static_cast<std::size_t>(row) * wordsPerRow + col / WORDBITS].load(std::memory_order_relaxed)
+		>> (col % WORDBITS) & 1;
+}
+
+/* the bit decides which of two racing calls does the counting; the count
+ * changes last so that a query seeing it sees the counters too */
+inline bool Overlay::change(int row, int col, bool block) {
+	std::uint64_t mask = std::uint64_t(1) << (col % WORDBITS);
+	std::atomic<std::uint64_t>& word = bits[static_cast<std::size_t>(row) * wordsPerRow + col / WORDBITS];
+	std::uint64_t old = block ? word.fetch_or(mask, std::memory_order_acq_rel) :
+		word.fetch_and(~mask, std::memory_order_acq_rel);
+	if (static_cast<bool>(old & mask) == block)
+		return false;
+
+	/* unsigned, so adding -1 wraps around to one less */
+	std::uint32_t step = block ? 1 : -1;
+	int r0 = row > 0 ? row - 1 : row, r1 = row + 1 < mapHeight ? row + 1 : row;
+	int c0 = col > 0 ? col - 1 : col, c1 = col + 1 < mapWidth ? col + 1 : col;
+	for (int r = r0; r <= r1; ++r) {
+		for (int c = c0; c <= c1; ++c)
+			nearCells[static_cast<std::size_t>(r) * mapWidth + c].fetch_add(static_cast<std::uint8_t>(step),
+				std::memory_order_relaxed);
+		rows[r].fetch_add(step * (c1 - c0 + 1), std::memory_order_relaxed);
+	}
+	for (int c = c0; c <= c1; ++c)
+		cols[c].fetch_add(step * (r1 - r0 + 1), std::memory_order_relaxed);
+	count.fetch_add(block ? 1 : -1, std::memory_order_release);
+	return true;
+}
+
+#endif /* OVERLAY_HPP */
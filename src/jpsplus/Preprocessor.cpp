@@ -0,0 +1,599 @@
+#include "Preprocessor.hpp"
+#include "DistanceTableFile.hpp"
+#include "MapFormat.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <unordered_set>
+
+bool Preprocessor::read(Scanner& in) {
+	if (!readMapHeader(in, mapWidth, mapHeight))
+		return false;
+	wallRows.resize(mapHeight, mapWidth, true);
+	distance.resize(mapHeight, mapWidth);
+
+	for (int r = 0; r < mapHeight; ++r)
+		if (!readMapRow(in, mapWidth, wallRows.line(r)))
+			return false;
+	wallCols = wallRows.transposed();
+	return true;
+}
+
+bool Preprocessor::preprocessing() {
+	preprocess();
+	return writeDistances();
+}
+
+void Preprocessor::preprocess() {
+	// printMap();
+	auto start = std::chrono::steady_clock::now();
+	calculatePrimaryJumpPoints();
+	// printAllPrimaryJumpPoints();
+	calculateStraightJumpPoints();
+	calculateDiagonalJumpPoints();
+	preprocessingTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+bool Preprocessor::writeDistances() {
+	if (!tableFile.empty())
+		return DistanceTableFile::write(tableFile, wallRows, distance,
+			compactTable ? DistanceTableFile::LAYOUT_COMPACT : DistanceTableFile::LAYOUT_DENSE);
+	printDistances();
+	return true;
+}
+
+void Preprocessor::setTableFile(const std::string& path, bool compact) {
+	tableFile = path;
+	compactTable = compact;
+}
+
+void Preprocessor::setThreadCount(int threads) {
+	threadCount = threads > 0 ? threads : hardwareThreads();
+}
+
+void Preprocessor::calculatePrimaryJumpPoints() {
+	/* along a row WEST/EAST predecessors sit at the next/previous column, along
+	 * a column NORTH/SOUTH predecessors sit at the next/previous row */
+	calculateJumpPoints(wallRows, jumpPoint[WEST], -1);
+	calculateJumpPoints(wallRows, jumpPoint[EAST], 1);
+	calculateJumpPoints(wallCols, jumpPoint[NORTH], -1);
+	calculateJumpPoints(wallCols, jumpPoint[SOUTH], 1);
+}
+
+void Preprocessor::calculateJumpPoints(const BitGrid& walls, BitGrid& jumpPoints, int step) {
+	jumpPoints.resize(walls.lineCount(), walls.lineLength());
+	parallelFor(threadCount, walls.lineCount(), [&](int begin, int end) {
+		for (int l = begin; l < end; ++l)
+			calculateLineJumpPoints(walls, step, l, jumpPoints.line(l));
+	});
+}
+
+/*
+ * Cell i of line l is a jump point when it and its predecessor i - step are
+ * open and on one of the neighbouring lines the cell next to the predecessor
+ * is a wall while the cell next to i is open (a forced neighbour). All of it
+ * is evaluated 64 cells at a time; `pred` moves the bit of cell i - step to
+ * position i, carrying across word boundaries.
+ */
+void Preprocessor::calculateLineJumpPoints(const BitGrid& walls, int step, int l, BitGrid::word* out) {
+	using word = BitGrid::word;
+	const int lines = walls.lineCount();
+	const int words = walls.wordsPerLine();
+
+	auto pred = [&](const word* line, int k, bool open) -> word {
+		auto at = [&](int i) -> word { return open ? ~line[i] : line[i]; };
+		if (step > 0)
+			return at(k) << 1 | (k > 0 ? at(k - 1) >> 63 : 0);
+		return at(k) >> 1 | (k + 1 < words ? at(k + 1) << 63 : 0);
+	};
+
+	const word* cur = walls.line(l);
+	const word* prev = l > 0 ? walls.line(l - 1) : nullptr;
+	const word* next = l + 1 < lines ? walls.line(l + 1) : nullptr;
+
+	for (int k = 0; k < words; ++k) {
+		word forced = 0;
+		if (prev)
+			forced |= pred(prev, k, false) & ~prev[k];
+		if (next)
+			forced |= pred(next, k, false) & ~next[k];
+		out[k] = ~cur[k] & pred(cur, k, true) & forced;
+	}
+}
+
+/*
+ * NORTH (pred = the row below) or SOUTH (pred = the row above) primary jump
+ * points of one row, straight from the bit-packed rows: the cell and its
+ * predecessor are open and next to them a wall beside the predecessor
+ * opens up beside the cell. Same rule as calculateLineJumpPoints() on the
+ * transposed walls.
+ */
+void Preprocessor::calculateRowColumnJumpPoints(const BitGrid::word* cur, const BitGrid::word* pred,
+	int words, BitGrid::word* out) {
+	using word = BitGrid::word;
+	/* bit c of the result is bit c - 1 (left) or c + 1 (right) of the row */
+	auto left = [&](const word* row, int k) -> word { return row[k] << 1 | (k > 0 ? row[k - 1] >> 63 : 0); };
+	auto right = [&](const word* row, int k) -> word { return row[k] >> 1 | (k + 1 < words ? row[k + 1] << 63 : 0); };
+
+	for (int k = 0; k < words; ++k) {
+		word forced = (left(pred, k) & ~left(cur, k)) | (right(pred, k) & ~right(cur, k));
+		out[k] = ~cur[k] & ~pred[k] & forced;
+	}
+}
+
+void Preprocessor::calculateStraightJumpPoints() {
+	const std::ptrdiff_t rowStride = DIRCOUNT;
+
+	/* WEST and EAST cardinal directions, rows are independent */
+	parallelFor(threadCount, mapHeight, [&](int begin, int end) {
+		for (int r = begin; r < end; ++r) {
+			scanLineDistances(wallRows.line(r), jumpPoint[WEST].line(r), mapWidth, -1,
+				&distance[r][0][WEST], rowStride);
+			scanLineDistances(wallRows.line(r), jumpPoint[EAST].line(r), mapWidth, 1,
+				&distance[r][0][EAST], rowStride);
+		}
+	});
+
+	/* NORTH and SOUTH cardinal directions, columns are independent; they are
+	 * scanned a block at a time into a row-major buffer so that distance is
+	 * written row by row instead of one cache line (and page) per cell */
+	constexpr int COLBLOCK = 16;
+	const int blocks = (mapWidth + COLBLOCK - 1) / COLBLOCK;
+	parallelFor(threadCount, blocks, [&](int begin, int end) {
+		std::vector<int> block(static_cast<std::size_t>(mapHeight) * COLBLOCK * 2);
+		for (int b = begin; b < end; ++b) {
+			const int c0 = b * COLBLOCK;
+			const int cols = std::min(COLBLOCK, mapWidth - c0);
+			for (int i = 0; i < cols; ++i) {
+				scanLineDistances(wallCols.line(c0 + i), jumpPoint[NORTH].line(c0 + i), mapHeight, -1,
+					&block[2 * i], 2 * cols);
+				scanLineDistances(wallCols.line(c0 + i), jumpPoint[SOUTH].line(c0 + i), mapHeight, 1,
+					&block[2 * i + 1], 2 * cols);
+			}
+
+			for (int r = 0; r < mapHeight; ++r) {
+				const int* src = &block[static_cast<std::size_t>(r) * cols * 2];
+				for (int i = 0; i < cols; ++i) {
+					distance[r][c0 + i][NORTH] = src[2 * i];
+					distance[r][c0 + i][SOUTH] = src[2 * i + 1];
+				}
+			}
+		}
+	});
+}
+
+/*
+ * Walks the walls and jump points of one line in increasing order with
+ * count-trailing-zero scans. Every open cell gets the distance to the first
+ * event met when moving by `step`: positive to a jump point, or minus the
+ * number of open cells before a wall (the line ends count as walls).
+ */
+void Preprocessor::scanLineDistances(const BitGrid::word* walls, const BitGrid::word* jumpPoints,
+	int length, int step, int* out, std::ptrdiff_t stride) {
+	const int words = (length + BitGrid::WORDBITS - 1) / BitGrid::WORDBITS;
+	int last = -1; /* previous event */
+	bool lastWall = true;
+
+	auto onEvent = [&](int e, bool isWall) {
+		if (step > 0) {
+			/* cells in [last, e) look forward to e, a jump point at last included */
+			for (int i = lastWall ? last + 1 : last; i < e; ++i)
+				out[i * stride] = isWall ? -(e - i - 1) : e - i;
+		}
+		else {
+			/* cells in (last, e] look back to last, e itself only when open */
+			for (int i = last + 1; i < e + !isWall; ++i)
+				out[i * stride] = lastWall ? -(i - last - 1) : i - last;
+		}
+		last = e;
+		lastWall = isWall;
+	};
+
+	for (int k = 0; k < words; ++k) {
+		BitGrid::word events = walls[k] | jumpPoints[k];
+		while (events) {
+			int e = k * BitGrid::WORDBITS + __builtin_ctzll(events);
+			if (e >= length)
+				break;
+			onEvent(e, walls[k] >> (e % BitGrid::WORDBITS) & 1);
+			events &= events - 1;
+		}
+	}
+	onEvent(length, true);
+}
+
+/*
+ * NORTHWEST and NORTHEAST are swept from the top row down, SOUTHWEST and
+ * SOUTHEAST from the bottom row up, and every row depends only on the row
+ * before it. With several threads the columns are split into chunks that
+ * advance as a wavefront: a chunk may compute its next row as soon as the
+ * neighbouring chunk it reads from (on the side the diagonal comes from)
+ * has finished the previous one.
+ */
+void Preprocessor::calculateDiagonalJumpPoints() {
+	for (direction dir : {NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST}) {
+		auto row = [&](int step) { return drow[dir] > 0 ? mapHeight - 1 - step : step; };
+		const int chunks = std::min(threadCount, mapWidth);
+
+		if (chunks <= 1) {
+			for (int step = 0; step < mapHeight; ++step)
+				calculateDiagonalRow(dir, row(step), 0, mapWidth);
+			continue;
+		}
+
+		std::vector<std::atomic<int>> rowsDone(chunks);
+		for (auto& done : rowsDone)
+			done.store(0, std::memory_order_relaxed);
+
+		parallelRun(chunks, [&](int k) {
+			const int cBegin = static_cast<long long>(mapWidth) * k / chunks;
+			const int cEnd = static_cast<long long>(mapWidth) * (k + 1) / chunks;
+			const int source = k + dcol[dir];
+			const bool hasSource = 0 <= source && source < chunks;
+
+			for (int step = 0; step < mapHeight; ++step) {
+				if (hasSource)
+					while (rowsDone[source].load(std::memory_order_acquire) < step)
+						std::this_thread::yield();
+				calculateDiagonalRow(dir, row(step), cBegin, cEnd);
+				rowsDone[k].store(step + 1, std::memory_order_release);
+			}
+		});
+	}
+}
+
+void Preprocessor::calculateDiagonalRow(const direction& dir, int r, int cBegin, int cEnd) {
+	for (int c = cBegin; c < cEnd; ++c)
+		if (!isWall(r, c))
+			calculateDiagonalCell(dir, r, c);
+}
+
+void Preprocessor::calculateDiagonalCell(const direction& dir, const int& r, const int& c) {
+	int dr = drow[dir];
+	int dc = dcol[dir];
+	int pr = r + dr;
+	int pc = c + dc;
+
+	if (!inBounds(r + dr, c) || !inBounds(r, c + dc) || !inBounds(pr, pc) ||
+		isWall(r + dr, c) || isWall(r, c + dc) || isWall(pr, pc))
+		distance[r][c][dir] = 0;
+	else
+		distance[r][c][dir] = diagonalDistance(dir, distance[pr][pc]);
+}
+
+/* diagonal distance of a cell whose three neighbours towards its
+ * predecessor are open, from the distances of that predecessor */
+int Preprocessor::diagonalDistance(const direction& dir, const DistanceCell& pred) {
+	assert(validDirections[dir].size() >= 2);
+	int reldir1 = validDirections[dir][0];
+	int reldir2 = validDirections[dir][1];
+
+	if (pred[reldir1] > 0 || pred[reldir2] > 0)
+		return 1;
+	int d = pred[dir];
+	return d + (d <= 0 ? -1 : 1);
+}
+
+bool Preprocessor::preprocessStreaming(int bandRows, Scanner& in) {
+	assert(!tableFile.empty() && bandRows > 0);
+	auto start = std::chrono::steady_clock::now();
+
+	DistanceTableStream out;
+	bool ok = readMapHeader(in, mapWidth, mapHeight) && out.create(tableFile, mapWidth, mapHeight) &&
+		streamDown(in, out, bandRows) && streamUp(out, bandRows) && out.finish();
+
+	preprocessingTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	return ok;
+}
+
+/*
+ * Downward pass over bands of the text map. Line l of the band holds row
+ * r0 - 1 + l, so every band row has both vertical neighbours at hand (rows
+ * outside the map are walls, which never force a jump point). Between bands
+ * only the last finished row and the last NORTH event of every column are
+ * carried over. WEST, EAST, NORTH, NORTHWEST and NORTHEAST are final when a
+ * band is written.
+ */
+bool Preprocessor::streamDown(Scanner& in, DistanceTableStream& out, int bandRows) {
+	const int words = (mapWidth + BitGrid::WORDBITS - 1) / BitGrid::WORDBITS;
+	BitGrid walls(bandRows + 2, mapWidth, true);
+	BitGrid jumpWest(bandRows + 2, mapWidth), jumpEast(bandRows + 2, mapWidth);
+	std::vector<BitGrid::word> jumpNorth(words);
+	Grid<DistanceCell> band(bandRows, mapWidth);
+	std::vector<DistanceCell> prev(mapWidth);
+	std::vector<int> lastNorth(mapWidth, -1);
+	std::vector<char> lastNorthWall(mapWidth, true);
+
+	/* line l for row r, reading the map in order */
+	auto load = [&](int l, int r) {
+		if (0 <= r && r < mapHeight)
+			return readMapRow(in, mapWidth, walls.line(l));
+		std::fill(walls.line(l), walls.line(l) + words, ~BitGrid::word(0));
+		return true;
+	};
+
+	bool ok = load(0, -1);
+	for (int l = 1; l < bandRows + 2; ++l)
+		ok = ok && load(l, l - 1);
+
+	for (int r0 = 0; ok && r0 < mapHeight; r0 += bandRows) {
+		const int rows = std::min(bandRows, mapHeight - r0);
+		band.fill(DistanceCell{});
+
+		parallelFor(threadCount, rows, [&](int begin, int end) {
+			for (int i = begin; i < end; ++i) {
+				calculateLineJumpPoints(walls, -1, i + 1, jumpWest.line(i + 1));
+				calculateLineJumpPoints(walls, 1, i + 1, jumpEast.line(i + 1));
+				scanLineDistances(walls.line(i + 1), jumpWest.line(i + 1), mapWidth, -1,
+					&band[i][0][WEST], DIRCOUNT);
+				scanLineDistances(walls.line(i + 1), jumpEast.line(i + 1), mapWidth, 1,
+					&band[i][0][EAST], DIRCOUNT);
+			}
+		});
+
+		for (int i = 0; i < rows; ++i) {
+			const int r = r0 + i;
+			const BitGrid::word* wall = walls.line(i + 1);
+			calculateRowColumnJumpPoints(wall, walls.line(i + 2), words, jumpNorth.data());
+			for (int c = 0; c < mapWidth; ++c) {
+				bool isWall = wall[c / BitGrid::WORDBITS] >> (c % BitGrid::WORDBITS) & 1;
+				if (!isWall)
+					band[i][c][NORTH] = lastNorthWall[c] ? -(r - lastNorth[c] - 1) : r - lastNorth[c];
+				if (isWall || (jumpNorth[c / BitGrid::WORDBITS] >> (c % BitGrid::WORDBITS) & 1)) {
+					lastNorth[c] = r;
+					lastNorthWall[c] = isWall;
+				}
+			}
+
+			const DistanceCell* pred = i > 0 ? band[i - 1] : prev.data();
+			streamDiagonalRow(NORTHWEST, wall, walls.line(i), pred, band[i]);
+			streamDiagonalRow(NORTHEAST, wall, walls.line(i), pred, band[i]);
+		}
+
+		ok = out.writeWalls(r0, rows, walls.line(1)) && out.writeDistances(r0, rows, band[0]);
+		std::copy(band[rows - 1], band[rows - 1] + mapWidth, prev.begin());
+
+		/* the last band row and the one below it move up to lines 0 and 1 */
+		std::copy(walls.line(rows), walls.line(rows) + 2 * words, walls.line(0));
+		for (int l = 2; ok && l < bandRows + 2; ++l)
+			ok = load(l, r0 + rows - 1 + l);
+	}
+	return ok;
+}
+
+/*
+ * Upward pass over the file written by streamDown(), band by band from the
+ * bottom. Walls come back from the table's own WALLS section, and only the
+ * first finished row of the band below and the next SOUTH event of every
+ * column are carried over. Fills in SOUTH, SOUTHWEST and SOUTHEAST.
+ */
+bool Preprocessor::streamUp(DistanceTableStream& out, int bandRows) {
+	const int words = (mapWidth + BitGrid::WORDBITS - 1) / BitGrid::WORDBITS;
+	BitGrid walls(bandRows + 2, mapWidth, true);
+	std::vector<BitGrid::word> jumpSouth(words);
+	Grid<DistanceCell> band(bandRows, mapWidth);
+	std::vector<DistanceCell> next(mapWidth);
+	std::vector<int> nextSouth(mapWidth, mapHeight);
+	std::vector<char> nextSouthWall(mapWidth, true);
+
+	bool ok = true;
+	for (int r1 = mapHeight; ok && r1 > 0; ) {
+		const int r0 = std::max(0, r1 - bandRows);
+		const int rows = r1 - r0;
+
+		/* line l holds row r0 - 1 + l as in streamDown() */
+		const int first = std::max(r0 - 1, 0);
+		const int last = std::min(r1, mapHeight - 1);
+		std::fill(walls.line(0), walls.line(0) + words, ~BitGrid::word(0));
+		std::fill(walls.line(rows + 1), walls.line(rows + 1) + words, ~BitGrid::word(0));
+		ok = out.readWalls(first, last - first + 1, walls.line(first - r0 + 1)) &&
+			out.readDistances(r0, rows, band[0]);
+
+		for (int i = rows - 1; ok && i >= 0; --i) {
+			const int r = r0 + i;
+			const BitGrid::word* wall = walls.line(i + 1);
+			calculateRowColumnJumpPoints(wall, walls.line(i), words, jumpSouth.data());
+			for (int c = 0; c < mapWidth; ++c) {
+				bool isWall = wall[c / BitGrid::WORDBITS] >> (c % BitGrid::WORDBITS) & 1;
+				if (!isWall)
+					band[i][c][SOUTH] = nextSouthWall[c] ? -(nextSouth[c] - r - 1) : nextSouth[c] - r;
+				if (isWall || (jumpSouth[c / BitGrid::WORDBITS] >> (c % BitGrid::WORDBITS) & 1)) {
+					nextSouth[c] = r;
+					nextSouthWall[c] = isWall;
+				}
+			}
+
+			const DistanceCell* pred = i + 1 < rows ? band[i + 1] : next.data();
+			streamDiagonalRow(SOUTHWEST, wall, walls.line(i + 2), pred, band[i]);
+			streamDiagonalRow(SOUTHEAST, wall, walls.line(i + 2), pred, band[i]);
+		}
+
+		ok = ok && out.writeDistances(r0, rows, band[0]);
+		std::copy(band[0], band[0] + mapWidth, next.begin());
+		r1 = r0;
+	}
+	return ok;
+}
+
+/* calculateDiagonalCell() for one row, given its predecessor row */
+void Preprocessor::streamDiagonalRow(const direction& dir, const BitGrid::word* walls, const BitGrid::word* predWalls,
+	const DistanceCell* pred, DistanceCell* cells) {
+	auto wall = [](const BitGrid::word* row, int c) {
+		return row[c / BitGrid::WORDBITS] >> (c % BitGrid::WORDBITS) & 1;
+	};
+	const int dc = dcol[dir];
+
+	for (int c = 0; c < mapWidth; ++c) {
+		if (wall(walls, c))
+			continue;
+		int pc = c + dc;
+		if (pc < 0 || pc >= mapWidth || wall(predWalls, c) || wall(walls, pc) || wall(predWalls, pc))
+			cells[c][dir] = 0;
+		else
+			cells[c][dir] = diagonalDistance(dir, pred[pc]);
+	}
+}
+
+void Preprocessor::toggleCells(const std::vector<Cell>& cells) {
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<int> rows, cols;
+	for (const Cell& cell : cells) {
+		assert(inBounds(cell.row, cell.col));
+		bool wall = !isWall(cell.row, cell.col);
+		wallRows.set(cell.row, cell.col, wall);
+		wallCols.set(cell.col, cell.row, wall);
+		for (int d = -1; d <= 1; ++d) {
+			if (0 <= cell.row + d && cell.row + d < mapHeight)
+				rows.push_back(cell.row + d);
+			if (0 <= cell.col + d && cell.col + d < mapWidth)
+				cols.push_back(cell.col + d);
+		}
+	}
+	for (auto* lines : { &rows, &cols }) {
+		std::sort(lines->begin(), lines->end());
+		lines->erase(std::unique(lines->begin(), lines->end()), lines->end());
+	}
+
+	/* a primary jump point only looks at its own line and the two next to
+	 * it, and straight distances only at their own line */
+	std::vector<Cell> changed[4];
+	std::vector<int> line(std::max(mapWidth, mapHeight));
+	for (int r : rows)
+		for (direction dir : {WEST, EAST}) {
+			int step = dcol[dir];
+			calculateLineJumpPoints(wallRows, step, r, jumpPoint[dir].line(r));
+			scanLineDistances(wallRows.line(r), jumpPoint[dir].line(r), mapWidth, step, line.data(), 1);
+			for (int c = 0; c < mapWidth; ++c)
+				if (!isWall(r, c) && distance[r][c][dir] != line[c]) {
+					distance[r][c][dir] = line[c];
+					changed[dir].push_back({r, c});
+				}
+		}
+	for (int c : cols)
+		for (direction dir : {NORTH, SOUTH}) {
+			int step = drow[dir];
+			calculateLineJumpPoints(wallCols, step, c, jumpPoint[dir].line(c));
+			scanLineDistances(wallCols.line(c), jumpPoint[dir].line(c), mapHeight, step, line.data(), 1);
+			for (int r = 0; r < mapHeight; ++r)
+				if (!isWall(r, c) && distance[r][c][dir] != line[r]) {
+					distance[r][c][dir] = line[r];
+					changed[dir].push_back({r, c});
+				}
+		}
+
+	for (direction dir : {NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST})
+		updateDiagonal(dir, cells, changed);
+
+	updateTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * A diagonal distance depends on the walls around its cell and on the
+ * distances of its predecessor (r + dr, c + dc), so every cell forms a chain
+ * with its successors (r - dr, c - dc). Cells next to a toggled cell and
+ * successors of changed straight distances are recomputed, each followed
+ * down its chain for as long as its value keeps changing.
+ */
+void Preprocessor::updateDiagonal(const direction& dir, const std::vector<Cell>& toggled,
+	const std::vector<Cell> (&changed)[4]) {
+	const int dr = drow[dir];
+	const int dc = dcol[dir];
+	auto key = [&](int r, int c) { return static_cast<long long>(r) * mapWidth + c; };
+
+	std::vector<Cell> seeds;
+	for (const Cell& cell : toggled)
+		for (int r = cell.row - 1; r <= cell.row + 1; ++r)
+			for (int c = cell.col - 1; c <= cell.col + 1; ++c)
+				if (inBounds(r, c))
+					seeds.push_back({r, c});
+	for (int i = 0; i < 2; ++i)
+		for (const Cell& cell : changed[validDirections[dir][i]])
+			if (inBounds(cell.row - dr, cell.col - dc))
+				seeds.push_back({cell.row - dr, cell.col - dc});
+
+	/* predecessors come first in sweep order */
+	std::sort(seeds.begin(), seeds.end(), [&](const Cell& a, const Cell& b) {
+		return a.row != b.row ? (a.row < b.row) == (dr < 0) : a.col < b.col;
+	});
+	std::unordered_set<long long> pending;
+	for (const Cell& seed : seeds)
+		pending.insert(key(seed.row, seed.col));
+
+	for (const Cell& seed : seeds) {
+		bool predChanged = false;
+		for (int r = seed.row, c = seed.col; inBounds(r, c); r -= dr, c -= dc) {
+			bool isSeed = pending.erase(key(r, c)) > 0;
+			if (!isSeed && !predChanged)
+				break;
+
+			predChanged = false;
+			if (!isWall(r, c)) {
+				int old = distance[r][c][dir];
+				calculateDiagonalCell(dir, r, c);
+				predChanged = distance[r][c][dir] != old;
+			}
+		}
+	}
+}
+
+void Preprocessor::printMap() {
+	printf("  ");
+	for (int c = 0; c < mapWidth; ++c)
+		printf("%2d", c);
+	puts("");
+	for (int r = 0; r < mapHeight; ++r) {
+		printf("%2d", r);
+		for (int c = 0; c < mapWidth; ++c)
+			printf("%2s", isWall(r, c) ? "#" : ".");
+		puts("");
+	}
+	puts("");
+}
+
+void Preprocessor::printAllPrimaryJumpPoints() {
+	for (int r = 0; r < mapHeight; ++r)
+		for (int c = 0; c < mapWidth; ++c)
+			for (direction dir : {NORTH, SOUTH, WEST, EAST})
+				if (isJumpPoint(r, c, dir))
+					printMapWithPrimaryJumpPoint(r, c, dir);
+}
+
+void Preprocessor::printMapWithPrimaryJumpPoint(int jr, int jc, direction dir) {
+	int pr = jr - drow[dir], pc = jc - dcol[dir];
+	printf("  ");
+	for (int c = 0; c < mapWidth; ++c)
+		printf("%2d", c);
+	puts("");
+	for (int r = 0; r < mapHeight; ++r) {
+		printf("%2d", r);
+		for (int c = 0; c < mapWidth; ++c)
+			if (r == jr && c == jc)
+				printf("%2s", "N");
+			else if (r == pr && c == pc)
+				printf("%2s", "P");
+			else
+				printf("%2s", isWall(r, c) ? "#" : ".");
+		puts("");
+	}
+	printf("(%d, %d, %s)\n\n", jr, jc, dirToStr(dir).c_str());
+}
+
+void Preprocessor::printDistances() {
+	for (int r = 0; r < mapHeight; ++r)
+		for (int c = 0; c < mapWidth; ++c)
+			if (!isWall(r, c)) {
+				printf("%d %d", c, r);
+				for (direction dir : ALLDIRS)
+					printf(" %d", distance[r][c][dir]);
+				puts("");
+			}
+
+}
@@ -0,0 +1,129 @@
+#ifndef PREPROCESSOR_HPP
+#define PREPROCESSOR_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+#include "DistanceTableFile.hpp"
+#include "Grid.hpp"
+#include "Scanner.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * JPS+ preprocessing: primary jump points and the jump distances of every
+ * open cell in all eight directions.
+ */
+class Preprocessor {
+public:
+	struct Cell {
+		int row, col;
+	};
+
+	/* a native or MovingAI map, see MapFormat.hpp */
+	bool read(Scanner& in = Scanner::standardInput());
+	/* preprocess() followed by writeDistances() */
+	bool preprocessing();
+	void preprocess();
+	bool writeDistances();
+
+	/* flips the given cells between wall and open after preprocess() and
+	 * patches only what they affect: primary jump points and straight
+	 * distances on the neighbouring rows and columns, and the diagonal
+	 * distances downstream of any change. The result is identical to
+	 * running preprocess() on the edited map. */
+	void toggleCells(const std::vector<Cell>& cells);
+
+	/* out-of-core alternative to read() + preprocessing() for maps that do
+	 * not fit in memory: reads the map `bandRows` rows at a time
+	 * and writes a dense table file (setTableFile() is required). A downward
+	 * pass finishes everything but SOUTH, SOUTHWEST and SOUTHEAST, an upward
+	 * pass over the file fills those in; only a band and the rows next to it
+	 * are held in memory. The file is identical to the in-memory one. */
+	bool preprocessStreaming(int bandRows, Scanner& in = Scanner::standardInput());
+
+	/* write a binary table (see DistanceTableFile.hpp) instead of text,
+	 * optionally in the compact open-cells-only layout */
+	void setTableFile(const std::string& path, bool compact = false);
+
+	/* the preprocessed map, e.g. for a Runtime searching it in place */
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+	const BitGrid& walls() const { return wallRows; }
+	const Grid<DistanceCell>& distances() const { return distance; }
+
+	/* 0 picks one thread per hardware thread */
+	void setThreadCount(int threads);
+	int getThreadCount() const { return threadCount; }
+	/* wall-clock time of the last preprocessing() without printing, in ms */
+	double getPreprocessingTime() const { return preprocessingTime; }
+	/* wall-clock time of the last toggleCells(), in ms */
+	double getUpdateTime() const { return updateTime; }
+
+private:
+	void calculatePrimaryJumpPoints();
+	void calculateStraightJumpPoints();
+	void calculateDiagonalJumpPoints();
+	void calculateDiagonalRow(const direction& dir, int r, int cBegin, int cEnd);
+	inline void calculateDiagonalCell(const direction& dir, const int& r, const int& c);
+	void updateDiagonal(const direction& dir, const std::vector<Cell>& toggled,
+		const std::vector<Cell> (&changed)[4]);
+	static inline int diagonalDistance(const direction& dir, const DistanceCell& pred);
+
+	bool streamDown(Scanner& in, DistanceTableStream& out, int bandRows);
+	bool streamUp(DistanceTableStream& out, int bandRows);
+	void streamDiagonalRow(const direction& dir, const BitGrid::word* walls, const BitGrid::word* predWalls,
+		const DistanceCell* pred, DistanceCell* cells);
+
+	void calculateJumpPoints(const BitGrid& walls, BitGrid& jumpPoints, int step);
+	static void calculateLineJumpPoints(const BitGrid& walls, int step, int l, BitGrid::word* out);
+	static void calculateRowColumnJumpPoints(const BitGrid::word* cur, const BitGrid::word* pred,
+		int words, BitGrid::word* out);
+	static void scanLineDistances(const BitGrid::word* walls, const BitGrid::word* jumpPoints,
+		int length, int step, int* out, std::ptrdiff_t stride);
+
+	inline bool inBounds(const int& r, const int& c);
+	inline bool isWall(const int& r, const int& c);
+	inline bool isJumpPoint(const int& r, const int& c, const direction& dir);
+
+	void printMap();
+	void printAllPrimaryJumpPoints();
+	void printMapWithPrimaryJumpPoint(int jr, int jc, direction dir);
+	void printDistances();
+
+private:
+	int mapWidth = 0;
+	int mapHeight = 0;
+
+	int threadCount = 1;
+	double preprocessingTime = 0;
+	double updateTime = 0;
+	std::string tableFile;
+	bool compactTable = false;
+	/* walls bit-packed by rows and by columns, map border padded with walls */
+	BitGrid wallRows;
+	BitGrid wallCols;
+
+	/* primary jump points: WEST/EAST stored by rows, NORTH/SOUTH by columns */
+	BitGrid jumpPoint[4];
+	Grid<DistanceCell> distance;
+};
+
+bool Preprocessor::inBounds(const int& r, const int& c) {
+	return 0 <= r && r < mapHeight && 0 <= c && c < mapWidth;
+}
+
+bool Preprocessor::isWall(const int& r, const int& c) {
+	assert(inBounds(r, c));
+	return wallRows.get(r, c);
+}
+
+bool Preprocessor::isJumpPoint(const int& r, const int& c, const direction& dir) {
+	assert(inBounds(r, c) && dir < 4);
+	return dir == WEST || dir == EAST ? jumpPoint[dir].get(r, c) : jumpPoint[dir].get(c, r);
+}
+
+#endif /* PREPROCESSOR_HPP */
@@ -0,0 +1,956 @@
+#include "Runtime.hpp"
+#include "Common.hpp"
+#include "SlicedSearch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+const double Runtime::SQRT2 = std::sqrt(2.0);
+
+bool Runtime::read(bool compact, Scanner& in) {
+	int open;
+	if (!in.readInt(mapWidth) || !in.readInt(mapHeight) || !readQuery(in) || !in.readInt(open) ||
+		mapWidth < 0 || mapHeight < 0) {
+		fprintf(stderr, "malformed distance table header\n");
+		return false;
+	}
+
+	distanceStorage.resize(mapHeight, mapWidth);
+	resizeSearch();
+
+	/* cells not listed are walls */
+	BitGrid walls(mapHeight, mapWidth, true);
+	for (int r = 0; r < mapHeight; ++r)
+		for (int k = 0; k < walls.wordsPerLine(); ++k)
+			walls.line(r)[k] = ~BitGrid::word(0);
+
+	for (int i = 0; i < open; ++i) {
+		int col, row;
+		bool ok = in.readInt(col) && in.readInt(row) && inBounds(row, col);
+		for (const auto& dir : ALLDIRS)
+			ok = ok && in.readInt(distanceStorage[row][col][dir]);
+		if (!ok) {
+			fprintf(stderr, "malformed distance table entry %d\n", i);
+			return false;
+		}
+		walls.set(row, col, false);
+	}
+
+	encoding = compact ? ENCODING_COMPACT : ENCODING_DENSE;
+	if (compact) {
+		compactTable.build(walls, GridView<const DistanceCell>(distanceStorage));
+		distanceStorage = Grid<DistanceCell>();
+	}
+	else
+		denseTable = DenseDistanceTable(GridView<const DistanceCell>(distanceStorage));
+	return true;
+}
+
+bool Runtime::load(const std::string& path, bool verifyChecksum) {
+	if (!tableFile.map(path, verifyChecksum))
+		return false;
+
+	mapWidth = tableFile.header().width;
+	mapHeight = tableFile.header().height;
+	bool compact = tableFile.layout() == DistanceTableFile::LAYOUT_COMPACT;
+	encoding = compact ? ENCODING_COMPACT : ENCODING_DENSE;
+	if (compact)
+		tableFile.compact(compactTable);
+	else
+		denseTable = tableFile.dense();
+	resizeSearch();
+	return true;
+}
+
+void Runtime::use(const Preprocessor& preprocessor, bool compact) {
+	mapWidth = preprocessor.width();
+	mapHeight = preprocessor.height();
+	tableFile.unmap();
+	distanceStorage = Grid<DistanceCell>();
+
+	GridView<const DistanceCell> distances(preprocessor.distances().data(), mapHeight, mapWidth);
+	encoding = compact ? ENCODING_COMPACT : ENCODING_DENSE;
+	if (compact)
+		compactTable.build(preprocessor.walls(), distances);
+	else
+		denseTable = DenseDistanceTable(distances);
+	resizeSearch();
+}
+
+void Runtime::share(const Runtime& owner) {
+	mapWidth = owner.mapWidth;
+	mapHeight = owner.mapHeight;
+	tableFile.unmap();
+	distanceStorage = Grid<DistanceCell>();
+
+	encoding = owner.encoding;
+	const CompactDistanceTable& table = owner.compactTable;
+	if (encoding == ENCODING_COMPACT)
+		compactTable.view(table.width(), table.height(), table.wallWords(), table.rankWords(),
+			table.cellBytes(), table.escapeTable(), table.escapeCount());
+	else if (encoding == ENCODING_TILED)
+		tiledTable.view(mapWidth, mapHeight, owner.tiledTable.cellData());
+	else
+		denseTable = owner.denseTable;
+	resizeSearch();
+	goalBounds = owner.goalBounds;
+	landmarks = owner.landmarks;
+	hierarchy = owner.hierarchy;
+	suboptimality = owner.suboptimality;
+	overlay = owner.overlay;
+}
+
+void Runtime::tile() {
+	if (encoding == ENCODING_DENSE)
+		tiledTable.build(mapWidth, mapHeight, denseTable, [](int, int) { return true; });
+	else if (encoding == ENCODING_COMPACT)
+		tiledTable.build(mapWidth, mapHeight, compactTable,
+			[this](int r, int c) { return compactTable.isOpen(r, c); });
+	else
+		return;
+	encoding = ENCODING_TILED;
+	denseTable = DenseDistanceTable();
+	distanceStorage = Grid<DistanceCell>();
+
+	/* same map, so the bounds, landmarks, hierarchy and overlay still hold */
+	const GoalBounds* bounds = goalBounds;
+	const Landmarks* distances = landmarks;
+	const Hierarchy* clusters = hierarchy;
+	const Overlay* blocked = overlay;
+	resizeSearch();
+	goalBounds = bounds;
+	landmarks = distances;
+	hierarchy = clusters;
+	overlay = blocked;
+}
+
+bool Runtime::readQuery(Scanner& in) {
+	int sc, sr, gc, gr;
+	if (!in.readInt(sc) || !in.readInt(sr) || !in.readInt(gc) || !in.readInt(gr))
+		return false;
+	if (!inBounds(sr, sc) || !inBounds(gr, gc)) {
+		fprintf(stderr, "query (%d, %d) -> (%d, %d) is outside the map\n", sc, sr, gc, gr);
+		return false;
+	}
+	setQuery(sr, sc, gr, gc);
+	return true;
+}
+
+void Runtime::setQuery(int startRow, int startCol, int goalRow, int goalCol) {
+	this->startRow = startRow;
+	this->startCol = startCol;
+	this->goalRow = goalRow;
+	this->goalCol = goalCol;
+}
+
+bool Runtime::setGoalBounds(const GoalBounds* bounds) {
+	if (bounds && (bounds->width() != mapWidth || bounds->height() != mapHeight)) {
+		fprintf(stderr, "goal bounds are for a %dx%d map, not %dx%d\n",
+			bounds->width(), bounds->height(), mapWidth, mapHeight);
+		return false;
+	}
+	goalBounds = bounds;
+	return true;
+}
+
+bool Runtime::setLandmarks(const Landmarks* landmarks) {
+	if (landmarks && (landmarks->width() != mapWidth || landmarks->height() != mapHeight)) {
+		fprintf(stderr, "landmarks are for a %dx%d map, not %dx%d\n",
+			landmarks->width(), landmarks->height(), mapWidth, mapHeight);
+		return false;
+	}
+	this->landmarks = landmarks;
+	return true;
+}
+
+bool Runtime::setHierarchy(const Hierarchy* hierarchy, double suboptimality) {
+	if (hierarchy && (hierarchy->width() != mapWidth || hierarchy->height() != mapHeight)) {
+		fprintf(stderr, "hierarchy is for a %dx%d map, not %dx%d\n",
+			hierarchy->width(), hierarchy->height(), mapWidth, mapHeight);
+		return false;
+	}
+	if (!(suboptimality >= 1)) {
+		fprintf(stderr, "suboptimality %g is below 1\n", suboptimality);
+		return false;
+	}
+	this->hierarchy = hierarchy;
+	this->suboptimality = suboptimality;
+	return true;
+}
+
+bool Runtime::setOverlay(const Overlay* overlay) {
+	if (overlay && (overlay->width() != mapWidth || overlay->height() != mapHeight)) {
+		fprintf(stderr, "overlay is for a %dx%d map, not %dx%d\n",
+			overlay->width(), overlay->height(), mapWidth, mapHeight);
+		return false;
+	}
+	this->overlay = overlay;
+	return true;
+}
+
+bool Runtime::setFixedCosts(int cardinal, int diagonal) {
+	if (cardinal != 0 && (cardinal < 0 || diagonal < cardinal || diagonal > 2 * cardinal)) {
+		fprintf(stderr, "fixed costs %d:%d do not keep the octile heuristic consistent\n", cardinal, diagonal);
+		return false;
+	}
+	cardinalCost = cardinal;
+	diagonalCost = cardinal ? diagonal : 0;
+	/* the same buckets per step as with doubles */
+	if (cardinal)
+		fixedLists.bucket.setWidth(cardinal / 16.0);
+	return true;
+}
+
+bool Runtime::setBinaryTrace(const std::string& path) {
+	if (!binaryTrace.open(path))
+		return false;
+	trace = TRACE_BINARY;
+	return true;
+}
+
+template<typename Cost>
+void Runtime::resizeState(Grid<CellState<Cost>>& state) {
+	if (encoding == ENCODING_TILED)
+		state.resize(tiledTable.paddedHeight(), tiledTable.paddedWidth());
+	else
+		state.resize(mapHeight, mapWidth);
+}
+
+void Runtime::resizeSearch() {
+	resizeState(doubleState);
+	generation = 0;
+	/* bounds, landmarks, hierarchy and overlay belong to the previous table */
+	goalBounds = nullptr;
+	landmarks = nullptr;
+	hierarchy = nullptr;
+	overlay = nullptr;
+	doubleLists.binary.resize(mapHeight, mapWidth);
+	doubleLists.indexed.resize(mapHeight, mapWidth);
+	doubleLists.bucket.resize(mapHeight, mapWidth);
+	/* the other state is only sized once it is used */
+	fixedState = Grid<CellState<FixedCost>>();
+	fixedLists.indexed.resize(0, 0);
+	doubleBackState = Grid<CellState<double>>();
+	doubleBackLists.indexed.resize(0, 0);
+	fixedBackState = Grid<CellState<FixedCost>>();
+	fixedBackLists.indexed.resize(0, 0);
+	found = false;
+}
+
+void Runtime::nextGeneration() {
+	/* stamps are zero after resize(); on wrap-around they have to be
+	 * cleared once so no cell seems reached by an old search */
+	generation += 2;
+	if (generation == 0) {
+		for (std::size_t i = 0; i < doubleState.size(); ++i)
+			doubleState.data()[i].stamp = 0;
+		for (std::size_t i = 0; i < fixedState.size(); ++i)
+			fixedState.data()[i].stamp = 0;
+		for (std::size_t i = 0; i < doubleBackState.size(); ++i)
+			doubleBackState.data()[i].stamp = 0;
+		for (std::size_t i = 0; i < fixedBackState.size(); ++i)
+			fixedBackState.data()[i].stamp = 0;
+		generation = 2;
+	}
+}
+
+int Runtime::parentOf(int cell, bool backward) {
+	int r = cell / mapWidth, c = cell % mapWidth;
+	std::size_t slot = encoding == ENCODING_TILED ? tiledTable.index(r, c) :
+		static_cast<std::size_t>(r) * mapWidth + c;
+	return fixedSearch ? states<FixedCost>(backward)[slot].parent : states<double>(backward)[slot].parent;
+}
+
+const std::vector<Runtime::PathCell>& Runtime::jumpPath() {
+	if (refinedSearch)
+		return refinedPoints;
+	jumpPoints.clear();
+	if (!found)
+		return jumpPoints;
+	int last = bidirectionalSearch ? meetCell : goalRow * mapWidth + goalCol;
+	for (int cell = last; cell != -1; cell = parentOf(cell, false))
+		jumpPoints.push_back({ cell / mapWidth, cell % mapWidth });
+	std::reverse(jumpPoints.begin(), jumpPoints.end());
+	if (bidirectionalSearch)
+		for (int cell = parentOf(meetCell, true); cell != -1; cell = parentOf(cell, true))
+			jumpPoints.push_back({ cell / mapWidth, cell % mapWidth });
+	return jumpPoints;
+}
+
+const std::vector<Runtime::PathCell>& Runtime::cellPath() {
+	cells.clear();
+	const std::vector<PathCell>& points = jumpPath();
+	if (points.empty())
+		return cells;
+	/* consecutive jump points always lie on a straight or diagonal line */
+	cells.push_back(points.front());
+	for (std::size_t i = 1; i < points.size(); ++i) {
+		int dr = sign(points[i].row - points[i - 1].row);
+		int dc = sign(points[i].col - points[i - 1].col);
+		for (PathCell cell = points[i - 1]; cell.row != points[i].row || cell.col != points[i].col;) {
+			cell.row += dr;
+			cell.col += dc;
+			cells.push_back(cell);
+		}
+	}
+	return cells;
+}
+
+void Runtime::run() {
+	fixedSearch = cardinalCost != 0;
+	bidirectionalSearch = bidirectional;
+	if (!fixedSearch) {
+		if (bidirectional)
+			prepare(doubleBackState, doubleBackLists);
+		run(doubleLists, doubleBackLists);
+		return;
+	}
+	prepare(fixedState, fixedLists);
+	if (bidirectional)
+		prepare(fixedBackState, fixedBackLists);
+	run(fixedLists, fixedBackLists);
+}
+
+template<typename Cost>
+void Runtime::prepare(Grid<CellState<Cost>>& state, OpenLists<Cost>& lists) {
+	if (state.size() == doubleState.size())
+		return;
+	resizeState(state);
+	lists.binary.resize(mapHeight, mapWidth);
+	lists.indexed.resize(mapHeight, mapWidth);
+	lists.bucket.resize(mapHeight, mapWidth);
+}
+
+template<typename Cost>
+void Runtime::run(OpenLists<Cost>& lists, OpenLists<Cost>& back) {
+	switch (openList) {
+		case OPENLIST_INDEXED: run(lists.indexed, back.indexed); break;
+		case OPENLIST_BUCKET: run(lists.bucket, back.bucket); break;
+		default: run(lists.binary, back.binary); break;
+	}
+}
+
+template<typename OpenList>
+void Runtime::run(OpenList& open, OpenList& back) {
+	switch (trace) {
+		case TRACE_TEXT: run(open, back, textTrace); break;
+		case TRACE_BINARY: run(open, back, binaryTrace); break;
+		default: run(open, back, nullTrace); break;
+	}
+}
+
+template<typename OpenList, typename Trace>
+void Runtime::run(OpenList& open, OpenList& back, Trace& sink) {
+	switch (encoding) {
+		case ENCODING_COMPACT: run(compactTable, open, back, sink); break;
+		case ENCODING_TILED: run(tiledTable, open, back, sink); break;
+		default: run(denseTable, open, back, sink); break;
+	}
+}
+
+template<typename Table, typename OpenList, typename Trace>
+void Runtime::run(const Table& table, OpenList& open, OpenList& back, Trace& sink) {
+	refinedSearch = false;
+	abstractExpansions = 0;
+	/* read once, cells blocked later on may or may not be seen */
+	overlaid = overlay && overlay->blockedCount() > 0;
+	if (hierarchy && suboptimality > 1 &&
+		hierarchy->clusterOf(startRow, startCol) != hierarchy->clusterOf(goalRow, goalCol))
+		hierarchicalSearch(table, open, sink);
+	else if (bidirectional)
+		bisearch(table, open, back, sink);
+	else
+		search(table, open, sink);
+	sink.finish(found, pathCost);
+}
+
+template<typename Cost>
+void Runtime::stepCosts(Cost& cardinal, Cost& diagonal) const {
+	if constexpr (std::is_same<Cost, FixedCost>::value) {
+		cardinal = cardinalCost;
+		diagonal = diagonalCost;
+	}
+	else {
+		cardinal = 1;
+		diagonal = SQRT2;
+	}
+}
+
+template<typename Node, typename Cost>
+Node Runtime::makeNode(int row, int col, int prow, int pcol, direction dir, const Cost& sortCost, const Cost& givenCost) {
+	if constexpr (std::is_same<Cost, FixedCost>::value)
+		return { row, col, prow, pcol, dir, sortCost, givenCost };
+	else
+		return { row, col, prow, pcol, dir, sortCost };
+}
+
+template<typename Table, typename Node, typename Cost, typename Visit>
+void Runtime::successors(const Table& table, const bool& overlaid, const Node& curNode, const Cost& curDist,
+	const int& targetRow, const int& targetCol, const Cost& cardinal, const Cost& diagonal, Visit visit) const {
+	int toGoalDiffRow = targetRow - curNode.row;
+	int toGoalDiffCol = targetCol - curNode.col;
+
+	for (const auto& dir : validDirections[curNode.dir]) {
+		/* bounds of the map without the overlay */
+		if (goalBounds && !overlaid && !goalBounds->contains(curNode.row, curNode.col, dir, targetRow, targetCol))
+			continue;
+
+		int succRow = -1, succCol = -1;
+		Cost givenCost = -1;
+
+		bool isDirCardinal = isCardinal(dir);
+		int dr = drow[dir];
+		int dc = dcol[dir];
+		int jump = overlaid ? overlayJump(table, curNode.row, curNode.col, dir) : table.get(curNode.row, curNode.col, dir);
+		int dist = abs(jump);
+		bool inDirectionRow = sign(toGoalDiffRow) == dr;
+		bool inDirectionCol = sign(toGoalDiffCol) == dc;
+
+		debug(isDirCardinal, dr, dc, dist, inDirectionRow, inDirectionCol, dirToStr(dir));
+
+		if (isDirCardinal && inDirectionRow && inDirectionCol &&
+			abs(toGoalDiffRow) + abs(toGoalDiffCol) <= dist) {
+			succRow = targetRow;
+			succCol = targetCol;
+			givenCost = curDist + (abs(toGoalDiffRow) + abs(toGoalDiffCol)) * cardinal;
+		}
+		else if (!isDirCardinal && inDirectionRow && inDirectionCol &&
+			(abs(toGoalDiffRow) <= dist || abs(toGoalDiffCol) <= dist)) {
+			int minToGoalDiff = std::min(abs(toGoalDiffRow), abs(toGoalDiffCol));
+			succRow = curNode.row + dr * minToGoalDiff;
+			succCol = curNode.col + dc * minToGoalDiff;
+			givenCost = curDist + minToGoalDiff * diagonal;
+		}
+		else if (jump > 0) {
+			succRow = curNode.row + dr * dist;
+			succCol = curNode.col + dc * dist;
+			givenCost = curDist + dist * (isDirCardinal ? cardinal : diagonal);
+		}
+
+		assert((succRow == -1 && succCol == -1) || (succRow >= 0 && succCol >= 0
+			&& succRow < mapHeight && succCol < mapWidth));
+		
+		if (succRow != -1 && succCol != -1) {
+			assert(givenCost != -1);
+			visit(succRow, succCol, dir, givenCost);
+		}
+	}
+}
+
+/*
+ * The overlay changes the map only next to blocked cells, where near() is
+ * not 0. Elsewhere the table stays right, so a jump follows it as far as
+ * the table or the first cell near a blocked one, whichever comes first,
+ * and decides that cell as preprocessing would have on the edited map: a
+ * wall if it is blocked, a jump point if a wall beside the cell before it
+ * opens up beside it, and on from there otherwise. A diagonal stops where a
+ * straight jump from it reaches a jump point; those are right from the
+ * table unless their row or column has a blocked cell near it.
+ */
+template<typename Table>
+int Runtime::overlayJump(const Table& table, int row, int col, direction dir) const {
+	return isCardinal(dir) ? overlayStraight(table, row, col, dir) : overlayDiagonal(table, row, col, dir);
+}
+
+template<typename Table>
+int Runtime::overlayStraight(const Table& table, int row, int col, direction dir) const {
+	const int dr = drow[dir], dc = dcol[dir];
+	if (dr ? overlay->colNear(col) == 0 : overlay->rowNear(row) == 0)
+		return table.get(row, col, dir);
+	const direction sides[2][2] = { { NORTH, SOUTH }, { WEST, EAST } };
+	const direction* side = sides[dr != 0];
+
+	int moved = 0;
+	for (;;) {
+		int jump = table.get(row, col, dir);
+		int dist = abs(jump);
+		int k = 1;
+		while (k <= dist && overlay->near(row + k * dr, col + k * dc) == 0)
+			++k;
+		if (k > dist)
+			return jump > 0 ? moved + jump : -(moved + dist);
+
+		/* open in the table, k - 1 cells on from an open one */
+		int r = row + k * dr, c = col + k * dc;
+		if (overlay->blocked(r, c))
+			return -(moved + k - 1);
+		for (int i = 0; i < 2; ++i)
+			if (overlayWall(table, r - dr, c - dc, side[i]) && !overlayWall(table, r, c, side[i]))
+				return moved + k;
+		moved += k;
+		row = r;
+		col = c;
+	}
+}
+
+template<typename Table>
+int Runtime::overlayDiagonal(const Table& table, int row, int col, direction dir) const {
+	const int dr = drow[dir], dc = dcol[dir];
+	const direction vertical = validDirections[dir][0], horizontal = validDirections[dir][1];
+
+	int moved = 0;
+	for (;;) {
+		int jump = table.get(row, col, dir);
+		int dist = abs(jump);
+		int k = 1;
+		while (k <= dist && overlay->rowNear(row + k * dr) == 0 && overlay->colNear(col + k * dc) == 0)
+			++k;
+		if (k > dist)
+			return jump > 0 ? moved + jump : -(moved + dist);
+
+		/* the step from the cell before is open in the table */
+		int r = row + k * dr, c = col + k * dc;
+		if (overlay->blocked(r, c) || overlay->blocked(r, c - dc) || overlay->blocked(r - dr, c))
+			return -(moved + k - 1);
+		if (overlayStraight(table, r, c, vertical) > 0 || overlayStraight(table, r, c, horizontal) > 0)
+			return moved + k;
+		moved += k;
+		row = r;
+		col = c;
+	}
+}
+
+template<typename Table, typename OpenList, typename Trace>
+void Runtime::search(const Table& table, OpenList& open, Trace& sink) {
+	using Node = decltype(open.pop());
+	using Cost = decltype(Node::sortCost);
+	Cost cardinal, diagonal;
+	stepCosts(cardinal, diagonal);
+	/* costs are reported in steps either way */
+	auto steps = [&](const Cost& cost) { return static_cast<double>(cost) / cardinal; };
+	CellState<Cost>* state = states<Cost>(false);
+	/* no node at or above limit is expanded or even pushed */
+	Cost limit = unreached<Cost>();
+	if (costLimit < INFINITY) {
+		if constexpr (std::is_same<Cost, FixedCost>::value)
+			limit = static_cast<Cost>(std::ceil(costLimit * cardinal));
+		else
+			limit = costLimit;
+	}
+
+	const float* goalLandmarks = landmarksAt(goalRow, goalCol);
+
+	nextGeneration();
+	found = false;
+	pathCost = INFINITY;
+	expansions = 0;
+	if (overlaid && (overlay->blocked(startRow, startCol) || overlay->blocked(goalRow, goalCol)))
+		return;
+
+	Node start = makeNode<Node>(startRow, startCol, -1, -1, NONE,
+		heuristic(startRow, startCol, goalRow, goalCol, cardinal, diagonal, goalLandmarks), Cost(0));
+	reach<Cost>(state[table.index(startRow, startCol)], 0, -1);
+	open.clear();
+	open.push(start);
+
+	while (!open.empty()) {
+		Node curNode = open.pop();
+
+		/* popped cells were reached in this search, their state is current */
+		CellState<Cost>& cur = state[table.index(curNode.row, curNode.col)];
+		if (cur.stamp != generation)
+			continue;
+		if (!(curNode.sortCost < limit))
+			break;
+		cur.stamp = generation + 1;
+
+		Cost curDist = cur.cost;
+		++expansions;
+		sink.expand(curNode.col, curNode.row, curNode.pcol, curNode.prow, steps(curDist));
+		debug(curNode.sortCost);
+
+		if (curNode.row == goalRow && curNode.col == goalCol) {
+			found = true;
+			pathCost = steps(curDist);
+			return;
+		}
+
+		successors(table, overlaid, curNode, curDist, goalRow, goalCol, cardinal, diagonal,
+			[&](int succRow, int succCol, direction dir, const Cost& givenCost) {
+				CellState<Cost>& succ = state[table.index(succRow, succCol)];
+				if (givenCost < distance(succ)) {
+					Cost sortCost = givenCost + heuristic(succRow, succCol, goalRow, goalCol, cardinal, diagonal, goalLandmarks);
+					if (!(sortCost < limit))
+						return;
+					reach(succ, givenCost, curNode.row * mapWidth + curNode.col);
+					open.push(makeNode<Node>(succRow, succCol, curNode.row, curNode.col, dir, sortCost, givenCost));
+				}
+			});
+	}
+}
+
+/*
+ * Two JPS+ searches taking turns, one from the start toward the goal and
+ * one from the goal toward the start over the same table, which serves as
+ * its own reverse: every move is allowed both ways at the same cost, so a
+ * path the backward search finds is a forward path read back to front.
+ * A cell reached by both gives a path, the best so far is `best`. Each side
+ * on its own is an exact A*, whose smallest open f never exceeds the
+ * optimal cost, so once either side pops f >= best, best is optimal. That
+ * rule does not need the two sides to meet at a shared jump point, which
+ * pruning makes rare. Until they meet, the side with the smaller open list
+ * expands, then the one whose f is higher and so nearer to proving best.
+ * Cells the other side has expanded cannot be skipped: JPS+ also expands
+ * cells off the canonical paths, at more than their true distance.
+ */
+template<typename Table, typename OpenList, typename Trace>
+void Runtime::bisearch(const Table& table, OpenList& open, OpenList& back, Trace& sink) {
+	using Node = decltype(open.pop());
+	using Cost = decltype(Node::sortCost);
+	Cost cardinal, diagonal;
+	stepCosts(cardinal, diagonal);
+	auto steps = [&](const Cost& cost) { return static_cast<double>(cost) / cardinal; };
+
+	struct Side {
+		OpenList& open;
+		CellState<Cost>* state;
+		CellState<Cost>* other;
+		int sourceRow, sourceCol;
+		int targetRow, targetCol;
+		const float* targetLandmarks;
+	};
+	Side sides[2] = {
+		{ open, states<Cost>(false), states<Cost>(true), startRow, startCol, goalRow, goalCol,
+			landmarksAt(goalRow, goalCol) },
+		{ back, states<Cost>(true), states<Cost>(false), goalRow, goalCol, startRow, startCol,
+			landmarksAt(startRow, startCol) }
+	};
+
+	nextGeneration();
+	found = false;
+	pathCost = INFINITY;
+	expansions = 0;
+	meetCell = -1;
+	Cost best = unreached<Cost>();
+	if (overlaid && (overlay->blocked(startRow, startCol) || overlay->blocked(goalRow, goalCol)))
+		return;
+
+	for (Side& side : sides) {
+		reach<Cost>(side.state[table.index(side.sourceRow, side.sourceCol)], 0, -1);
+		side.open.clear();
+		side.open.push(makeNode<Node>(side.sourceRow, side.sourceCol, -1, -1, NONE,
+			heuristic(side.sourceRow, side.sourceCol, side.targetRow, side.targetCol, cardinal, diagonal,
+				side.targetLandmarks), Cost(0)));
+	}
+	/* start and goal may be the same cell */
+	if (startRow == goalRow && startCol == goalCol) {
+		best = 0;
+		meetCell = startRow * mapWidth + startCol;
+	}
+
+	Cost lastF[2] = { 0, 0 };
+	for (;;) {
+		int turn = best < unreached<Cost>() ? lastF[1] > lastF[0] : back.size() < open.size();
+		Side& side = sides[turn];
+		bool done = true;
+		while (!side.open.empty()) {
+			Node curNode = side.open.pop();
+			CellState<Cost>& cur = side.state[table.index(curNode.row, curNode.col)];
+			if (cur.stamp != generation)
+				continue;
+			/* the smallest f of this side */
+			if (!(curNode.sortCost < best))
+				break;
+			cur.stamp = generation + 1;
+			done = false;
+			lastF[turn] = curNode.sortCost;
+
+			Cost curDist = cur.cost;
+			++expansions;
+			sink.expand(curNode.col, curNode.row, curNode.pcol, curNode.prow, steps(curDist));
+
+			successors(table, overlaid, curNode, curDist, side.targetRow, side.targetCol, cardinal, diagonal,
+				[&](int succRow, int succCol, direction dir, const Cost& givenCost) {
+					std::size_t slot = table.index(succRow, succCol);
+					CellState<Cost>& succ = side.state[slot];
+					if (!(givenCost < distance(succ)))
+						return;
+					reach(succ, givenCost, curNode.row * mapWidth + curNode.col);
+					Cost other = distance(side.other[slot]);
+					if (other < best && givenCost + other < best) {
+						best = givenCost + other;
+						meetCell = succRow * mapWidth + succCol;
+					}
+					Cost sortCost = givenCost + heuristic(succRow, succCol, side.targetRow, side.targetCol, cardinal, diagonal,
+						side.targetLandmarks);
+					/* nothing through it can beat best */
+					if (sortCost < best)
+						side.open.push(makeNode<Node>(succRow, succCol, curNode.row, curNode.col, dir, sortCost, givenCost));
+				});
+			break;
+		}
+		if (done)
+			break;
+	}
+
+	if (meetCell == -1)
+		return;
+	found = true;
+	pathCost = steps(best);
+}
+
+/*
+ * The abstract path of the hierarchy, refined by JPS+ searches from each
+ * waypoint to the next; they are short and not traced. A refined path of
+ * cost U is then checked by one JPS+ search from the start that stops
+ * before popping f >= U / suboptimality: f never exceeds the optimal cost
+ * C* below the goal, so stopping there means U <= suboptimality * C*, and
+ * reaching the goal first gives a path shorter than U, which is taken
+ * instead. The check costs nothing with infinite suboptimality and grows
+ * toward a plain search as it nears 1, which is why 1 never gets here.
+ */
+template<typename Table, typename OpenList, typename Trace>
+void Runtime::hierarchicalSearch(const Table& table, OpenList& open, Trace& sink) {
+	bidirectionalSearch = false;
+	double abstractCost;
+	bool linked = hierarchy->findPath(hierarchySearch, { startRow, startCol }, { goalRow, goalCol },
+		waypoints, abstractCost);
+	abstractExpansions = hierarchy->getExpansions(hierarchySearch);
+	/* clusters keep every connection of the map */
+	if (!linked) {
+		found = false;
+		pathCost = INFINITY;
+		expansions = 0;
+		return;
+	}
+
+	const int queryRow[2] = { startRow, goalRow };
+	const int queryCol[2] = { startCol, goalCol };
+	refinedPoints.clear();
+	double refinedCost = 0;
+	long refineExpansions = 0;
+	for (std::size_t i = 1; i < waypoints.size(); ++i) {
+		setQuery(waypoints[i - 1].row, waypoints[i - 1].col, waypoints[i].row, waypoints[i].col);
+		search(table, open, nullTrace);
+		refineExpansions += expansions;
+		if (!found)
+			break;
+		refinedCost += pathCost;
+		const std::vector<PathCell>& points = jumpPath();
+		refinedPoints.insert(refinedPoints.end(), points.begin() + (refinedPoints.empty() ? 0 : 1), points.end());
+	}
+	setQuery(queryRow[0], queryCol[0], queryRow[1], queryCol[1]);
+	bool refined = found;
+
+	/* a waypoint the refinement could not reach leaves the plain search */
+	costLimit = refined ? refinedCost / suboptimality : INFINITY;
+	search(table, open, sink);
+	costLimit = INFINITY;
+	expansions += refineExpansions;
+	if (found || !refined)
+		return;
+	found = true;
+	pathCost = refinedCost;
+	refinedSearch = true;
+}
+
+void Runtime::buildFlowField(FlowField& field) {
+	auto start = std::chrono::steady_clock::now();
+	switch (encoding) {
+		case ENCODING_COMPACT: flood(compactTable, field); break;
+		case ENCODING_TILED: flood(tiledTable, field); break;
+		default: flood(denseTable, field); break;
+	}
+	field.buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Dijkstra from the goal in canonical order (Sturtevant and Rabin): a node
+ * sends rays out in the directions a search continues in after reaching
+ * it, a straight ray ends at a wall or a jump point, which becomes a node,
+ * and a diagonal one sends straight rays out from each of its cells. Every
+ * cell on a ray is given its distance and the step back along the ray
+ * unless it has a shorter distance already, which also ends the ray. The
+ * table gives how far each ray goes without testing a single wall. Moves
+ * are the same both ways, so the rays out of the goal are the paths into
+ * it read backwards.
+ */
+template<typename Table>
+void Runtime::flood(const Table& table, FlowField& field) {
+	using Node = SearchNode<double>;
+	CellState<double>* state = states<double>(false);
+	BinaryHeap<Node>& open = doubleLists.binary;
+
+	nextGeneration();
+	found = false;
+	refinedSearch = false;
+	bidirectionalSearch = false;
+	fixedSearch = false;
+	expansions = 0;
+	overlaid = overlay && overlay->blockedCount() > 0;
+	/* a blocked goal is reached from nowhere, not even from itself */
+	if (overlaid && overlay->blocked(goalRow, goalCol)) {
+		field.reset(mapHeight, mapWidth, -1, -1);
+		return;
+	}
+	field.reset(mapHeight, mapWidth, goalRow, goalCol);
+
+	/* false if the cell is as near already */
+	auto reached = [&](int row, int col, direction dir, double dist) {
+		CellState<double>& cell = state[table.index(row, col)];
+		if (!(dist < distance(cell)))
+			return false;
+		reach(cell, dist, (row - drow[dir]) * mapWidth + col - dcol[dir]);
+		field.set(row, col, reverse(dir));
+		return true;
+	};
+	auto straight = [&](int row, int col, direction dir, double dist) {
+		int jump = overlaid ? overlayStraight(table, row, col, dir) : table.get(row, col, dir);
+		for (int k = abs(jump); k > 0; --k) {
+			row += drow[dir];
+			col += dcol[dir];
+			dist += 1;
+			if (!reached(row, col, dir, dist))
+				return;
+		}
+		/* expanded already, a shorter way there has to be expanded again */
+		if (jump > 0) {
+			state[table.index(row, col)].stamp = generation;
+			open.push(makeNode<Node>(row, col, row - jump * drow[dir], col - jump * dcol[dir], dir, dist, dist));
+		}
+	};
+	auto diagonal = [&](int row, int col, direction dir, double dist) {
+		const direction vertical = validDirections[dir][0], horizontal = validDirections[dir][1];
+		while (table.get(row, col, dir) != 0 && !(overlaid && (overlay->blocked(row + drow[dir], col + dcol[dir]) ||
+			overlay->blocked(row + drow[dir], col) || overlay->blocked(row, col + dcol[dir])))) {
+			row += drow[dir];
+			col += dcol[dir];
+			dist += SQRT2;
+			if (!reached(row, col, dir, dist))
+				return;
+			straight(row, col, vertical, dist);
+			straight(row, col, horizontal, dist);
+		}
+	};
+
+	reach<double>(state[table.index(goalRow, goalCol)], 0, -1);
+	open.clear();
+	open.push(makeNode<Node>(goalRow, goalCol, -1, -1, NONE, 0.0, 0.0));
+	while (!open.empty()) {
+		Node curNode = open.pop();
+		CellState<double>& cur = state[table.index(curNode.row, curNode.col)];
+		if (cur.stamp != generation)
+			continue;
+		cur.stamp = generation + 1;
+		++expansions;
+		for (const auto& dir : validDirections[curNode.dir]) {
+			if (isCardinal(dir))
+				straight(curNode.row, curNode.col, dir, cur.cost);
+			else
+				diagonal(curNode.row, curNode.col, dir, cur.cost);
+		}
+	}
+}
+
+void Runtime::start(SlicedSearch& search, int startRow, int startCol, int goalRow, int goalCol) const {
+	search.mapWidth = mapWidth;
+	search.startRow = startRow;
+	search.startCol = startCol;
+	search.goalRow = goalRow;
+	search.goalCol = goalCol;
+	search.fixed = cardinalCost != 0;
+	/* read once, as by run(), so that the slices see the same overlay */
+	search.overlaid = overlay && overlay->blockedCount() > 0;
+	search.fresh = true;
+	search.finished = false;
+	search.found = false;
+	search.pathCost = INFINITY;
+	search.expansions = 0;
+	search.closest = -1;
+	search.closestHeuristic = INFINITY;
+}
+
+bool Runtime::resume(SlicedSearch& search, long expansions, long nanoseconds) const {
+	if (!search.finished) {
+		if (search.fixed)
+			slice<FixedCost>(search, expansions, nanoseconds);
+		else
+			slice<double>(search, expansions, nanoseconds);
+	}
+	return search.finished;
+}
+
+template<typename Cost>
+void Runtime::slice(SlicedSearch& search, long expansions, long nanoseconds) const {
+	switch (encoding) {
+		case ENCODING_COMPACT: slice<CompactDistanceTable, Cost>(compactTable, search, expansions, nanoseconds); break;
+		case ENCODING_TILED: slice<TiledDistanceTable, Cost>(tiledTable, search, expansions, nanoseconds); break;
+		default: slice<DenseDistanceTable, Cost>(denseTable, search, expansions, nanoseconds); break;
+	}
+}
+
+/*
+ * search() over the open list and hashed cell states of a SlicedSearch,
+ * which carry it from one call to the next: the same nodes are expanded in
+ * the same order as by a plain search over a binary heap, so far as the
+ * budget of the call goes.
+ */
+template<typename Table, typename Cost>
+void Runtime::slice(const Table& table, SlicedSearch& search, long expansions, long nanoseconds) const {
+	using Node = SearchNode<Cost>;
+	auto start = std::chrono::steady_clock::now();
+	Cost cardinal, diagonal;
+	stepCosts(cardinal, diagonal);
+	BinaryHeap<Node>& open = search.frontier<Cost>().open;
+	SparseState<Cost>& state = search.frontier<Cost>().state;
+	const int targetRow = search.goalRow, targetCol = search.goalCol;
+	const float* goalLandmarks = landmarksAt(targetRow, targetCol);
+
+	if (search.fresh) {
+		search.fresh = false;
+		state.clear();
+		open.clear();
+		if (search.overlaid && (overlay->blocked(search.startRow, search.startCol) || overlay->blocked(targetRow, targetCol))) {
+			search.finished = true;
+			return;
+		}
+		state.at(search.startRow * mapWidth + search.startCol).cost = 0;
+		open.push(makeNode<Node>(search.startRow, search.startCol, -1, -1, NONE,
+			heuristic(search.startRow, search.startCol, targetRow, targetCol, cardinal, diagonal, goalLandmarks), Cost(0)));
+	}
+
+	const std::uint32_t current = state.getGeneration();
+	const long first = search.expansions;
+	while (!open.empty()) {
+		/* out of budget, after at least one expansion */
+		if (search.expansions > first && ((expansions > 0 && search.expansions - first >= expansions) ||
+			(nanoseconds > 0 && std::chrono::steady_clock::now() - start >= std::chrono::nanoseconds(nanoseconds))))
+			return;
+		Node curNode = open.pop();
+		int curCell = curNode.row * mapWidth + curNode.col;
+
+		CellState<Cost>& cur = state.at(curCell);
+		if (cur.stamp != current)
+			continue;
+		cur.stamp = current + 1;
+
+		/* the state moves as successors are reached */
+		Cost curDist = cur.cost;
+		++search.expansions;
+		double h = static_cast<double>(curNode.sortCost - curDist) / cardinal;
+		if (h < search.closestHeuristic) {
+			search.closestHeuristic = h;
+			search.closest = curCell;
+		}
+
+		if (curNode.row == targetRow && curNode.col == targetCol) {
+			search.found = true;
+			search.pathCost = static_cast<double>(curDist) / cardinal;
+			search.finished = true;
+			return;
+		}
+
+		successors(table, search.overlaid, curNode, curDist, targetRow, targetCol, cardinal, diagonal,
+			[&](int succRow, int succCol, direction dir, const Cost& givenCost) {
+				CellState<Cost>& succ = state.at(succRow * mapWidth + succCol);
+				if (givenCost < succ.cost) {
+					succ.cost = givenCost;
+					succ.parent = curCell;
+					Cost sortCost = givenCost + heuristic(succRow, succCol, targetRow, targetCol, cardinal, diagonal, goalLandmarks);
+					open.push(makeNode<Node>(succRow, succCol, curNode.row, curNode.col, dir, sortCost, givenCost));
+				}
+			});
+	}
+	search.finished = true;
+}
@@ -0,0 +1,445 @@
+#ifndef RUNTIME_HPP
+#define RUNTIME_HPP
+
+#include "BitGrid.hpp"
+#include "Direction.hpp"
+#include "DistanceTable.hpp"
+#include "DistanceTableFile.hpp"
+#include "FlowField.hpp"
+#include "GoalBounds.hpp"
+#include "Grid.hpp"
+#include "Hierarchy.hpp"
+#include "Landmarks.hpp"
+#include "OpenList.hpp"
+#include "Overlay.hpp"
+#include "Preprocessor.hpp"
+#include "Scanner.hpp"
+#include "TraceSink.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <string>
+#include <vector>
+#include <cmath>
+
+class SlicedSearch;
+
+/* integer path cost, in units of 1 / cardinal step cost */
+using FixedCost = std::int64_t;
+
+/*
+ * Open list entry. With double costs nodes are ordered by sortCost alone, as
+ * they always were; with fixed costs ties are exact and common, so they go
+ * to the larger g first and then to the lower row and column, which makes
+ * the order total and every open list expand the same nodes.
+ */
+template<typename Cost>
+struct SearchNode {
+	int row, col;
+	int prow, pcol;
+	direction dir;
+	Cost sortCost;
+
+	bool before(const SearchNode& o) const { return sortCost < o.sortCost; }
+	/* reversed, std::push_heap keeps the largest on top */
+	bool operator<(const SearchNode& o) const { return o.before(*this); }
+};
+
+template<>
+struct SearchNode<FixedCost> {
+	int row, col;
+	int prow, pcol;
+	direction dir;
+	FixedCost sortCost;
+	FixedCost givenCost = 0;
+
+	bool before(const SearchNode& o) const {
+		if (sortCost != o.sortCost)
+			return sortCost < o.sortCost;
+		if (givenCost != o.givenCost)
+			return givenCost > o.givenCost;
+		return row != o.row ? row < o.row : col < o.col;
+	}
+	bool operator<(const SearchNode& o) const { return o.before(*this); }
+};
+
+/*
+ * Search state of one cell, packed so that an expansion touches a single
+ * cache line per cell. Valid only where stamp is the current generation,
+ * which is always even; stamp is one more once the cell was expanded.
+ */
+template<typename Cost>
+struct CellState {
+	Cost cost;
+	/* row * mapWidth + col of the predecessor, -1 at the start */
+	std::int32_t parent;
+	std::uint32_t stamp;
+};
+
+/*
+ * JPS+ search over a distance table, printing every expanded node. The
+ * table comes from text, a mapped table file or, with no copy, straight
+ * from a Preprocessor in the same process.
+ */
+class Runtime {
+public:
+	/* open list implementations, see OpenList.hpp */
+	enum openListType {
+		OPENLIST_BINARY = 0, /* lazy binary heap, the original expansion order */
+		OPENLIST_INDEXED,    /* indexed 4-ary heap with decrease-key */
+		OPENLIST_BUCKET      /* bucket queue on quantized f-cost */
+	};
+
+	/* `compact` re-encodes the parsed distances as a CompactDistanceTable */
+	bool read(bool compact = false, Scanner& in = Scanner::standardInput());
+	/* map a binary table written by `preprocessing -o` and read only the
+	 * start and goal ("startCol startRow goalCol goalRow") from stdin */
+	bool load(const std::string& path, bool verifyChecksum = false);
+	/* search the distances of `preprocessor` in place, which has to stay
+	 * alive and unchanged while it is in use; `compact` searches an
+	 * encoded copy instead */
+	void use(const Preprocessor& preprocessor, bool compact = false);
+	/* search the table of `owner` with search state of our own, so that
+	 * several threads can answer queries over one table; `owner` has to
+	 * stay alive and must not load another table meanwhile */
+	void share(const Runtime& owner);
+	/* re-encode the table being searched in 8x8 blocks, see
+	 * TiledDistanceTable, and lay the search state out the same way */
+	void tile();
+	/* "startCol startRow goalCol goalRow"; any number of queries can be
+	 * read and run against the same table */
+	bool readQuery(Scanner& in = Scanner::standardInput());
+	void setQuery(int startRow, int startCol, int goalRow, int goalCol);
+	void getQuery(int& startRow, int& startCol, int& goalRow, int& goalCol) const {
+		startRow = this->startRow;
+		startCol = this->startCol;
+		goalRow = this->goalRow;
+		goalCol = this->goalCol;
+	}
+	void run();
+
+	/* size of the map being searched */
+	int width() const { return mapWidth; }
+	int height() const { return mapHeight; }
+
+	void setOpenList(openListType type) { openList = type; }
+
+	/* search from the start and from the goal at once, see bisearch() */
+	void setBidirectional(bool enabled) { bidirectional = enabled; }
+
+	/* search with integer costs, `cardinal` per straight and `diagonal`
+	 * per diagonal step (1000 and 1414, say), instead of 1 and sqrt(2) as
+	 * doubles; costs are still reported in steps. Needs
+	 * 0 < cardinal <= diagonal <= 2 * cardinal, and cardinal 0 goes back
+	 * to double costs */
+	bool setFixedCosts(int cardinal, int diagonal);
+
+	/* skip directions whose goal bounds do not hold the goal; `bounds`
+	 * must be built for the same map and outlive its use, nullptr
+	 * searches without */
+	bool setGoalBounds(const GoalBounds* bounds);
+
+	/* take the larger of octile distance and the lower bounds of
+	 * `landmarks`, which must be built for the same map and outlive their
+	 * use; nullptr goes back to octile distance alone */
+	bool setLandmarks(const Landmarks* landmarks);
+
+	/* answer queries between two clusters of `hierarchy` over its abstract
+	 * graph, refined with JPS+ from waypoint to waypoint, and keep the
+	 * refined path once a JPS+ search from the start shows it is at most
+	 * `suboptimality` times as long as an optimal one; infinity takes it as
+	 * it is. That check would cost as much as a plain search with 1, so
+	 * exact answers are not sped up: 1 searches without the hierarchy.
+	 * These searches go one way only. `hierarchy` must be built for the
+	 * same map and outlive its use, nullptr searches without */
+	bool setHierarchy(const Hierarchy* hierarchy, double suboptimality = 1);
+
+	/* treat the blocked cells of `overlay` as walls, with the same results
+	 * as a table preprocessed with them: near blocked cells jumps are cut
+	 * short and continued cell by cell, elsewhere the table holds. Goal
+	 * bounds are not used while any cell is blocked. The overlay may change
+	 * while queries run (see Overlay.hpp); it must be sized for the same
+	 * map and outlive its use, nullptr searches without */
+	bool setOverlay(const Overlay* overlay);
+
+	/* one search outward from the goal of the current query that leaves in
+	 * `field` the first step of an optimal path from every open cell, for
+	 * any number of agents going there; see flood(). Costs are 1 and sqrt(2)
+	 * whatever setFixedCosts() says, goal bounds and landmarks are not used
+	 * and the path of the last run() is gone */
+	void buildFlowField(FlowField& field);
+
+	/* expansion trace, see TraceSink.hpp */
+	enum traceType {
+		TRACE_NONE = 0,
+		TRACE_TEXT,   /* the text format on stdout, the default */
+		TRACE_BINARY  /* BinaryTrace records */
+	};
+
+	/* print every expanded node (the default) or search silently */
+	void setTrace(bool enabled) { trace = enabled ? TRACE_TEXT : TRACE_NONE; }
+	/* log expansions of every following run() to `path` as BinaryTrace */
+	bool setBinaryTrace(const std::string& path);
+	/* outcome of the last run() */
+	bool pathFound() const { return found; }
+	double getPathCost() const { return pathCost; }
+	/* JPS+ expansions, with a hierarchy those of the refinement too */
+	long getExpansions() const { return expansions; }
+	/* abstract nodes expanded, 0 unless the hierarchy was searched */
+	long getAbstractExpansions() const { return abstractExpansions; }
+
+	struct PathCell {
+		int row, col;
+	};
+	/* path of the last run() from start to goal, empty if there is none:
+	 * the jump points only, or every cell along it. The vectors are
+	 * reused by every query and valid until the next run() */
+	const std::vector<PathCell>& jumpPath();
+	const std::vector<PathCell>& cellPath();
+
+	/* a query searched in slices, for a budget per frame: start() sets
+	 * `search` up with the current settings, then every resume() expands up
+	 * to `expansions` nodes or for about `nanoseconds` (0 for no limit, at
+	 * least one node either way) and returns true once it is over, found or
+	 * not. A SlicedSearch holds its own open list and the state of the cells
+	 * it reached, and only reads this Runtime, so any number of them can be
+	 * suspended over one table while run() answers other queries; the table
+	 * and settings must stay as they are. These searches go one way over a
+	 * binary heap, without a hierarchy and untraced */
+	void start(SlicedSearch& search, int startRow, int startCol, int goalRow, int goalCol) const;
+	bool resume(SlicedSearch& search, long expansions, long nanoseconds = 0) const;
+
+private:
+	/* kept across queries so their storage is reused */
+	template<typename Cost>
+	struct OpenLists {
+		BinaryHeap<SearchNode<Cost>> binary;
+		IndexedHeap<SearchNode<Cost>> indexed;
+		BucketQueue<SearchNode<Cost>> bucket;
+	};
+
+	inline bool inBounds(const int& r, const int& c) const;
+	inline int sign(const int& x) const;
+	/* octile distance to the target, or the landmark bound if larger;
+	 * `target` is the target's landmarks->at(), nullptr without landmarks */
+	template<typename Cost>
+	inline Cost heuristic(const int& row, const int& col, const int& targetRow, const int& targetCol,
+		const Cost& cardinal, const Cost& diagonal, const float* target) const;
+	inline const float* landmarksAt(const int& row, const int& col) const;
+	/* table.get() with the overlay cells as walls, for a cell open in both */
+	template<typename Table>
+	int overlayJump(const Table& table, int row, int col, direction dir) const;
+	template<typename Table>
+	int overlayStraight(const Table& table, int row, int col, direction dir) const;
+	template<typename Table>
+	int overlayDiagonal(const Table& table, int row, int col, direction dir) const;
+	/* whether the cardinal neighbour of an open cell is a wall or blocked */
+	template<typename Table>
+	inline bool overlayWall(const Table& table, const int& row, const int& col, const direction& dir) const;
+	/* step costs in the search's cost type */
+	template<typename Cost>
+	void stepCosts(Cost& cardinal, Cost& diagonal) const;
+	template<typename Node, typename Cost>
+	static Node makeNode(int row, int col, int prow, int pcol, direction dir, const Cost& sortCost, const Cost& givenCost);
+
+	/* starts a search: the state of every cell becomes stale at once */
+	void nextGeneration();
+	/* state of every cell in the search's cost type, by table index(), of
+	 * the forward or the backward search */
+	template<typename Cost>
+	inline CellState<Cost>* states(bool backward);
+	/* g of a cell, unreached() unless reached in this search */
+	template<typename Cost>
+	inline Cost distance(const CellState<Cost>& state);
+	template<typename Cost>
+	static inline Cost unreached();
+	template<typename Cost>
+	inline void reach(CellState<Cost>& state, const Cost& dist, const int& parent);
+	/* the predecessor recorded by the last run(), as row * mapWidth + col */
+	int parentOf(int cell, bool backward);
+
+	/* sizes the per-cell search state to the map */
+	void resizeSearch();
+	/* state laid out like the table */
+	template<typename Cost>
+	void resizeState(Grid<CellState<Cost>>& state);
+	/* sizes state used only by some searches on first use */
+	template<typename Cost>
+	void prepare(Grid<CellState<Cost>>& state, OpenLists<Cost>& lists);
+
+	template<typename Cost>
+	void run(OpenLists<Cost>& lists, OpenLists<Cost>& back);
+	template<typename OpenList>
+	void run(OpenList& open, OpenList& back);
+	template<typename OpenList, typename Trace>
+	void run(OpenList& open, OpenList& back, Trace& sink);
+	template<typename Table, typename OpenList, typename Trace>
+	void run(const Table& table, OpenList& open, OpenList& back, Trace& sink);
+	/* visit(row, col, dir, g) for every successor of a node at g `curDist`
+	 * in a search toward the target, around the overlay if `overlaid` */
+	template<typename Table, typename Node, typename Cost, typename Visit>
+	void successors(const Table& table, const bool& overlaid, const Node& curNode, const Cost& curDist,
+		const int& targetRow, const int& targetCol, const Cost& cardinal, const Cost& diagonal, Visit visit) const;
+	template<typename Table, typename OpenList, typename Trace>
+	void search(const Table& table, OpenList& open, Trace& sink);
+	template<typename Table, typename OpenList, typename Trace>
+	void bisearch(const Table& table, OpenList& open, OpenList& back, Trace& sink);
+	template<typename Table, typename OpenList, typename Trace>
+	void hierarchicalSearch(const Table& table, OpenList& open, Trace& sink);
+	template<typename Table>
+	void flood(const Table& table, FlowField& field);
+	/* resume() in the search's cost type, over the active encoding */
+	template<typename Cost>
+	void slice(SlicedSearch& search, long expansions, long nanoseconds) const;
+	template<typename Table, typename Cost>
+	void slice(const Table& table, SlicedSearch& search, long expansions, long nanoseconds) const;
+
+private:
+	int mapWidth = 0;
+	int mapHeight = 0;
+
+	int startRow;
+	int startCol;
+	int goalRow;
+	int goalCol;
+
+	/* parsed from text, or viewing a mapped table file or a Preprocessor;
+	 * run() searches whichever encoding is active */
+	enum encodingType {
+		ENCODING_DENSE = 0,
+		ENCODING_COMPACT,
+		ENCODING_TILED
+	};
+	encodingType encoding = ENCODING_DENSE;
+	DenseDistanceTable denseTable;
+	CompactDistanceTable compactTable;
+	TiledDistanceTable tiledTable;
+	Grid<DistanceCell> distanceStorage;
+	MappedDistanceTable tableFile;
+
+	const GoalBounds* goalBounds = nullptr;
+	const Landmarks* landmarks = nullptr;
+
+	const Hierarchy* hierarchy = nullptr;
+	double suboptimality = 1;
+	Hierarchy::Search hierarchySearch;
+	std::vector<Hierarchy::Cell> waypoints;
+	/* search() stops before popping f >= costLimit, in steps */
+	double costLimit = INFINITY;
+	/* whether the last path is refinedPoints rather than in the state */
+	bool refinedSearch = false;
+	std::vector<PathCell> refinedPoints;
+	long abstractExpansions = 0;
+
+	const Overlay* overlay = nullptr;
+	/* whether the current query has blocked cells to go around */
+	bool overlaid = false;
+
+	traceType trace = TRACE_TEXT;
+	NullTrace nullTrace;
+	TextTrace textTrace;
+	BinaryTrace binaryTrace;
+	bool found = false;
+	double pathCost = 0;
+	long expansions = 0;
+
+	/* per-cell search state, one slot per table index(), stale unless
+	 * stamped with the current generation, so a query never has to clear
+	 * the whole map. Only one of them is used at a time and the fixed-cost
+	 * one is sized on first use */
+	Grid<CellState<double>> doubleState;
+	Grid<CellState<FixedCost>> fixedState;
+	/* of the backward search, both sized on first use */
+	Grid<CellState<double>> doubleBackState;
+	Grid<CellState<FixedCost>> fixedBackState;
+	std::uint32_t generation = 0;
+	/* how the last run() searched; a bidirectional path runs through
+	 * meetCell, from which the backward parents lead to the goal */
+	bool fixedSearch = false;
+	bool bidirectionalSearch = false;
+	int meetCell = -1;
+
+	/* reusable output, so steady-state queries do not allocate */
+	std::vector<PathCell> jumpPoints;
+	std::vector<PathCell> cells;
+
+	openListType openList = OPENLIST_BINARY;
+	OpenLists<double> doubleLists;
+	OpenLists<FixedCost> fixedLists;
+	OpenLists<double> doubleBackLists;
+	OpenLists<FixedCost> fixedBackLists;
+	bool bidirectional = false;
+
+	/* step costs with fixed costs, 0 searches with doubles */
+	FixedCost cardinalCost = 0;
+	FixedCost diagonalCost = 0;
+
+	static const double SQRT2;
+};
+
+bool Runtime::inBounds(const int& r, const int& c) const {
+	return 0 <= r && r < mapHeight && 0 <= c && c < mapWidth;
+}
+
+int Runtime::sign(const int& x) const {
+	return x ? (x >> 31 | 1) : 0;
+}
+
+template<typename Cost>
+Cost Runtime::heuristic(const int& row, const int& col, const int& targetRow, const int& targetCol,
+	const Cost& cardinal, const Cost& diagonal, const float* target) const {
+	int dr = abs(row - targetRow);
+	int dc = abs(col - targetCol);
+	Cost octile = std::max(dr, dc) * cardinal + std::min(dr, dc) * (diagonal - cardinal);
+	if (!target)
+		return octile;
+	/* landmark distances are in steps of 1 and sqrt(2); fixed costs whose
+	 * diagonal is below sqrt(2) cardinals make paths cheaper, so the bound
+	 * shrinks with them */
+	double scale = std::min<double>(cardinal, diagonal / SQRT2);
+	Cost bound = static_cast<Cost>(landmarks->bound(landmarks->at(row, col), target) * scale);
+	return std::max(octile, bound);
+}
+
+template<typename Table>
+bool Runtime::overlayWall(const Table& table, const int& row, const int& col, const direction& dir) const {
+	/* 0 in a cardinal direction only with a wall next to the cell */
+	return table.get(row, col, dir) == 0 || overlay->blocked(row + drow[dir], col + dcol[dir]);
+}
+
+const float* Runtime::landmarksAt(const int& row, const int& col) const {
+	return landmarks ? landmarks->at(row, col) : nullptr;
+}
+
+template<typename Cost>
+CellState<Cost>* Runtime::states(bool backward) {
+	if constexpr (std::is_same<Cost, FixedCost>::value)
+		return backward ? fixedBackState.data() : fixedState.data();
+	else
+		return backward ? doubleBackState.data() : doubleState.data();
+}
+
+template<typename Cost>
+Cost Runtime::distance(const CellState<Cost>& state) {
+	return (state.stamp & ~1u) == generation ? state.cost : unreached<Cost>();
+}
+
+template<typename Cost>
+Cost Runtime::unreached() {
+	return std::numeric_limits<Cost>::has_infinity ?
+		std::numeric_limits<Cost>::infinity() : std::numeric_limits<Cost>::max();
+}
+
+/* an expanded cell stays expanded */
+template<typename Cost>
+void Runtime::reach(CellState<Cost>& state, const Cost& dist, const int& from) {
+	if ((state.stamp & ~1u) != generation)
+		state.stamp = generation;
+	state.cost = dist;
+	state.parent = from;
+}
+
+#endif /* RUNTIME_HPP */
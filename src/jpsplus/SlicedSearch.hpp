@@ -0,0 +1,215 @@
+#ifndef SLICEDSEARCH_HPP
+#define SLICEDSEARCH_HPP
+
+#include "OpenList.hpp"
+#include "Runtime.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Search state of the cells one search has reached, in an open-addressing
+ * table keyed by row * mapWidth + col: room for what the search reaches
+ * rather than for the whole map. As in Runtime, a slot is stale unless
+ * stamped with the current generation, so clear() is O(1) and stale slots
+ * count as empty. Nothing is removed within a generation, so probing stops
+ * at the first empty slot.
+ */
+template<typename Cost>
+class SparseState {
+public:
+	/* every cell unreached again, the storage kept */
+	inline void clear();
+	std::uint32_t getGeneration() const { return generation; }
+	/* state of `cell`, unreached with parent -1 if it is new; growing moves
+	 * the slots, so it is valid only until the next at() */
+	inline CellState<Cost>& at(int cell);
+	/* state of a cell reached since clear() */
+	inline const CellState<Cost>& get(int cell) const;
+	std::size_t bytes() const { return slots.capacity() * sizeof(Slot); }
+
+	static constexpr std::size_t MIN_CAPACITY = 1024;
+
+private:
+	struct Slot {
+		CellState<Cost> state;
+		std::int32_t cell;
+	};
+
+	bool live(const Slot& slot) const { return (slot.state.stamp & ~1u) == generation; }
+	/* Fibonacci hashing onto the power-of-two capacity */
+	std::size_t home(int cell) const { return static_cast<std::uint32_t>(cell) * 2654435769u >> shift; }
+	inline void grow();
+
+private:
+	std::vector<Slot> slots;
+	/* 32 - log2 of the capacity */
+	int shift = 0;
+	std::size_t count = 0;
+	/* even and never 0, which zeroed slots carry */
+	std::uint32_t generation = 2;
+};
+
+template<typename Cost>
+void SparseState<Cost>::clear() {
+	count = 0;
+	generation += 2;
+	if (generation == 0) {
+		for (Slot& slot : slots)
+			slot.state.stamp = 0;
+		generation = 2;
+	}
+}
+
+template<typename Cost>
+CellState<Cost>& SparseState<Cost>::at(int cell) {
+	/* at most half full keeps the probes short */
+	if ((count + 1) * 2 > slots.size())
+		grow();
+	const std::size_t mask = slots.size() - 1;
+	for (std::size_t i = home(cell);; i = (i + 1) & mask) {
+		Slot& slot = slots[i];
+		if (!live(slot)) {
+			slot.cell = cell;
+			slot.state.cost = std::numeric_limits<Cost>::has_infinity ?
+				std::numeric_limits<Cost>::infinity() : std::numeric_limits<Cost>::max();
+			slot.state.parent = -1;
+			slot.state.stamp = generation;
+			++count;
+			return slot.state;
+		}
+		if (slot.cell == cell)
+			return slot.state;
+	}
+}
+
+template<typename Cost>
+const CellState<Cost>& SparseState<Cost>::get(int cell) const {
+	const std::size_t mask = slots.size() - 1;
+	std::size_t i = home(cell);
+	while (slots[i].cell != cell || !live(slots[i]))
+		i = (i + 1) & mask;
+	return slots[i].state;
+}
+
+template<typename Cost>
+void SparseState<Cost>::grow() {
+	std::vector<Slot> old;
+	old.swap(slots);
+	slots.assign(std::max(MIN_CAPACITY, old.size() * 2), Slot{});
+	shift = 32;
+	for (std::size_t capacity = slots.size(); capacity > 1; capacity >>= 1)
+		--shift;
+	const std::size_t mask = slots.size() - 1;
+	for (const Slot& slot : old) {
+		if (!live(slot))
+			continue;
+		std::size_t i = home(slot.cell);
+		while (live(slots[i]))
+			i = (i + 1) & mask;
+		slots[i] = slot;
+	}
+}
+
+/*
+ * One search run in slices over the table of a Runtime, see
+ * Runtime::start() and resume(). It holds only its open list and the state
+ * of the cells it has reached, so any number of searches can be suspended
+ * over one table, and its storage is reused from query to query.
+ */
+class SlicedSearch {
+public:
+	struct Cell {
+		int row, col;
+	};
+
+	/* whether the search is over, found or not */
+	bool done() const { return finished; }
+	bool pathFound() const { return found; }
+	/* in steps, infinite without a path */
+	double getPathCost() const { return pathCost; }
+	long getExpansions() const { return expansions; }
+	/* the jump points from the start to the expanded cell with the lowest
+	 * heuristic, the whole path once it is found; valid until the next
+	 * call */
+	inline const std::vector<Cell>& partialPath();
+	/* storage held for the open list and the cell states */
+	inline std::size_t bytes() const;
+
+private:
+	friend class Runtime;
+
+	template<typename Cost>
+	struct Frontier {
+		BinaryHeap<SearchNode<Cost>> open;
+		SparseState<Cost> state;
+	};
+
+	template<typename Cost>
+	inline Frontier<Cost>& frontier();
+	/* path to `cell` along the parents */
+	template<typename Cost>
+	void trace(int cell);
+
+private:
+	int mapWidth = 0;
+	int startRow = 0;
+	int startCol = 0;
+	int goalRow = 0;
+	int goalCol = 0;
+	/* the cost type and overlay as Runtime::start() found them */
+	bool fixed = false;
+	bool overlaid = false;
+
+	/* started but not yet searched from */
+	bool fresh = false;
+	bool finished = true;
+	bool found = false;
+	double pathCost = INFINITY;
+	long expansions = 0;
+	/* the expanded cell with the lowest heuristic, as row * mapWidth + col */
+	int closest = -1;
+	double closestHeuristic = INFINITY;
+
+	Frontier<double> doubleFrontier;
+	Frontier<FixedCost> fixedFrontier;
+	std::vector<Cell> path;
+};
+
+const std::vector<SlicedSearch::Cell>& SlicedSearch::partialPath() {
+	path.clear();
+	int last = found ? goalRow * mapWidth + goalCol : closest;
+	if (fixed)
+		trace<FixedCost>(last);
+	else
+		trace<double>(last);
+	return path;
+}
+
+std::size_t SlicedSearch::bytes() const {
+	return doubleFrontier.open.capacity() * sizeof(SearchNode<double>) + doubleFrontier.state.bytes() +
+		fixedFrontier.open.capacity() * sizeof(SearchNode<FixedCost>) + fixedFrontier.state.bytes();
+}
+
+template<typename Cost>
+SlicedSearch::Frontier<Cost>& SlicedSearch::frontier() {
+	if constexpr (std::is_same<Cost, FixedCost>::value)
+		return fixedFrontier;
+	else
+		return doubleFrontier;
+}
+
+template<typename Cost>
+void SlicedSearch::trace(int cell) {
+	const SparseState<Cost>& state = frontier<Cost>().state;
+	for (; cell != -1; cell = state.get(cell).parent)
+		path.push_back({cell / mapWidth, cell % mapWidth});
+	std::reverse(path.begin(), path.end());
+}
+
+#endif /* SLICEDSEARCH_HPP */
@@ -0,0 +1,181 @@
+#ifndef TRACESINK_HPP
+#define TRACESINK_HPP
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Where the search reports its expansions. Sinks are a template parameter
+ * of the search loop, so the choice costs nothing per node: expand() for
+ * every expanded node, finish() once the search is over, with the path
+ * cost if the goal was reached.
+ */
+
+/* no trace at all; every call compiles away */
+struct NullTrace {
+	void expand(int, int, int, int, double) {}
+	void finish(bool, double) {}
+};
+
+/*
+ * The text format, "col row pcol prow cost" with two decimals per expanded
+ * node and "NO PATH" if the goal is unreachable, gathered in a buffer and
+ * written in large blocks instead of being flushed line by line.
+ */
+class TextTrace {
+public:
+	static constexpr std::size_t CAPACITY = 1 << 16;
+	/* longest line expand() writes: four ints, a cost, separators */
+	static constexpr std::size_t MAXLINE = 4 * 12 + 320 + 5;
+
+	explicit TextTrace(int fd = STDOUT_FILENO) : fd(fd), buffer(CAPACITY) {}
+	TextTrace(const TextTrace&) = delete;
+	TextTrace& operator=(const TextTrace&) = delete;
+	~TextTrace() { flush(); }
+
+	void expand(int col, int row, int pcol, int prow, double cost) {
+		if (buffer.size() - used < MAXLINE)
+			flush();
+		char* p = buffer.data() + used;
+		char* end = buffer.data() + buffer.size();
+		p = std::to_chars(p, end, col).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, end, row).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, end, pcol).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, end, prow).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, end, cost, std::chars_format::fixed, 2).ptr;
+		*p++ = '\n';
+		used = p - buffer.data();
+	}
+
+	void finish(bool found, double) {
+		if (!found) {
+			static const char NOPATH[] = "NO PATH\n";
+			if (buffer.size() - used < sizeof(NOPATH))
+				flush();
+			std::memcpy(buffer.data() + used, NOPATH, sizeof(NOPATH) - 1);
+			used += sizeof(NOPATH) - 1;
+		}
+		flush();
+	}
+
+	void flush() {
+		const char* p = buffer.data();
+		while (used > 0) {
+			ssize_t n = ::write(fd, p, used);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			p += n;
+			used -= n;
+		}
+		used = 0;
+	}
+
+private:
+	int fd;
+	std::vector<char> buffer;
+	std::size_t used = 0;
+};
+
+/*
+ * Compact expansion log: the magic "JPSTRACE" and a version, then one
+ * fixed-size Record per expanded node and, closing every search, a Record
+ * with all coordinates -1 and the path cost (infinity if there is none).
+ * Records are in host byte order and written when the buffer fills or
+ * the log is closed.
+ */
+class BinaryTrace {
+public:
+	struct Record {
+		std::int32_t col, row;
+		std::int32_t pcol, prow;
+		double cost;
+	};
+
+	static constexpr char MAGIC[8] = { 'J', 'P', 'S', 'T', 'R', 'A', 'C', 'E' };
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::size_t CAPACITY = 1 << 12;
+
+	BinaryTrace() { records.reserve(CAPACITY); }
+	BinaryTrace(const BinaryTrace&) = delete;
+	BinaryTrace& operator=(const BinaryTrace&) = delete;
+	~BinaryTrace() { close(); }
+
+	bool open(const std::string& path) {
+		close();
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			std::perror(path.c_str());
+			return false;
+		}
+		char header[sizeof(MAGIC) + sizeof(VERSION)];
+		std::memcpy(header, MAGIC, sizeof(MAGIC));
+		std::memcpy(header + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+		return write(header, sizeof(header));
+	}
+
+	void close() {
+		if (fd < 0)
+			return;
+		flush();
+		::close(fd);
+		fd = -1;
+	}
+
+	bool isOpen() const { return fd >= 0; }
+
+	void expand(int col, int row, int pcol, int prow, double cost) {
+		records.push_back({ col, row, pcol, prow, cost });
+		if (records.size() == CAPACITY)
+			flush();
+	}
+
+	void finish(bool found, double cost) {
+		records.push_back({ -1, -1, -1, -1, found ? cost : INFINITY });
+		if (records.size() == CAPACITY)
+			flush();
+	}
+
+	void flush() {
+		if (fd >= 0)
+			write(records.data(), records.size() * sizeof(Record));
+		records.clear();
+	}
+
+private:
+	bool write(const void* data, std::size_t bytes) {
+		const char* p = static_cast<const char*>(data);
+		while (bytes > 0) {
+			ssize_t n = ::write(fd, p, bytes);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0) {
+				std::perror("trace");
+				return false;
+			}
+			p += n;
+			bytes -= n;
+		}
+		return true;
+	}
+
+private:
+	int fd = -1;
+	std::vector<Record> records;
+};
+
+#endif /* TRACESINK_HPP */
@@ -1,9 +1,159 @@
-#include "JPSPlus.hpp"
+#include "GoalBounds.hpp"
+#include "Hierarchy.hpp"
+#include "Landmarks.hpp"
+#include "Preprocessor.hpp"
+#include "Scanner.hpp"
 
-int main() {
-	JPSPlus jpsPlus;
-	jpsPlus.read();
-	jpsPlus.preprocessing();
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+
+int main(int argc, char* argv[]) {
+	Preprocessor preprocessor;
+	bool stats = false;
+	bool update = false;
+	const char* tableFile = nullptr;
+	bool compact = false;
+	int bandRows = 0;
+	const char* boundsFile = nullptr;
+	const char* hierarchyFile = nullptr;
+	int clusterSize = Hierarchy::DEFAULT_CLUSTER;
+	const char* landmarksFile = nullptr;
+	int landmarkCount = Landmarks::DEFAULT_COUNT;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:so:zub:g:H:k:L:K:")) != -1) {
+		switch (opt) {
+			case 't':
+				preprocessor.setThreadCount(std::atoi(optarg));
+				break;
+			case 's':
+				stats = true;
+				break;
+			case 'o':
+				tableFile = optarg;
+				break;
+			case 'z':
+				compact = true;
+				break;
+			case 'u':
+				update = true;
+				break;
+			case 'b':
+				bandRows = std::atoi(optarg);
+				break;
+			case 'g':
+				boundsFile = optarg;
+				break;
+			case 'H':
+				hierarchyFile = optarg;
+				break;
+			case 'k':
+				clusterSize = std::atoi(optarg);
+				break;
+			case 'L':
+				landmarksFile = optarg;
+				break;
+			case 'K':
+				landmarkCount = std::atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-t threads] [-s] [-o table.bin [-z | -b rows]] [-u] [-g bounds.bin] [-H hierarchy.bin [-k cluster]] [-L landmarks.bin [-K count]] [map]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	/* the map comes from stdin unless a file is named, native or MovingAI */
+	Scanner& in = Scanner::standardInput();
+	Scanner mapFile;
+	if (optind < argc && !mapFile.open(argv[optind]))
+		return 1;
+	Scanner& mapInput = optind < argc ? mapFile : in;
+
+	/* -b: out-of-core preprocessing, `rows` map rows in memory at a time */
+	if (bandRows) {
+		if (!tableFile || compact || update || boundsFile || hierarchyFile || landmarksFile || bandRows < 0) {
+			fprintf(stderr, "%s: -b needs -o and a positive row count, and excludes -z, -u, -g, -H and -L\n", argv[0]);
+			return 1;
+		}
+		preprocessor.setTableFile(tableFile);
+		if (!preprocessor.preprocessStreaming(bandRows, mapInput))
+			return 1;
+		if (stats)
+			fprintf(stderr, "preprocessing: %.3f ms, %d threads\n",
+				preprocessor.getPreprocessingTime(), preprocessor.getThreadCount());
+		return 0;
+	}
+
+	if (tableFile)
+		preprocessor.setTableFile(tableFile, compact);
+
+	if (!preprocessor.read(mapInput))
+		return 1;
+	preprocessor.preprocess();
+	if (stats)
+		fprintf(stderr, "preprocessing: %.3f ms, %d threads\n",
+			preprocessor.getPreprocessingTime(), preprocessor.getThreadCount());
+
+	/* -u: the map is followed by a count and that many "col row" cells
+	 * whose wall state is flipped before the distances are written; with a
+	 * map file they come from stdin */
+	if (update) {
+		int count;
+		if (!in.readInt(count) || count < 0) {
+			fprintf(stderr, "%s: expected the number of cells to toggle\n", argv[0]);
+			return 1;
+		}
+		std::vector<Preprocessor::Cell> cells(count);
+		for (auto& cell : cells) {
+			if (!in.readInt(cell.col) || !in.readInt(cell.row)) {
+				fprintf(stderr, "%s: expected %d cells to toggle\n", argv[0], count);
+				return 1;
+			}
+			if (cell.row < 0 || cell.row >= preprocessor.height() || cell.col < 0 || cell.col >= preprocessor.width()) {
+				fprintf(stderr, "%s: cell (%d, %d) to toggle is outside the map\n", argv[0], cell.col, cell.row);
+				return 1;
+			}
+		}
+		preprocessor.toggleCells(cells);
+		if (stats)
+			fprintf(stderr, "update: %.3f ms, %d cells\n", preprocessor.getUpdateTime(), count);
+	}
+
+	if (!preprocessor.writeDistances())
+		return 1;
+
+	/* -g: goal bounds of the final map, a separate and much slower stage */
+	if (boundsFile) {
+		GoalBounds bounds;
+		if (!bounds.build(preprocessor.walls(), preprocessor.getThreadCount()) || !bounds.write(boundsFile))
+			return 1;
+		if (stats)
+			fprintf(stderr, "goal bounding: %.3f ms, %d threads\n",
+				bounds.getBuildTime(), preprocessor.getThreadCount());
+	}
+
+	/* -H: clusters of -k cells squared and their abstract graph */
+	if (hierarchyFile) {
+		Hierarchy hierarchy;
+		if (!hierarchy.build(preprocessor.walls(), clusterSize, preprocessor.getThreadCount()) ||
+			!hierarchy.write(hierarchyFile))
+			return 1;
+		if (stats)
+			fprintf(stderr, "hierarchy: %.3f ms, %d threads, %zu nodes, %zu edges\n", hierarchy.getBuildTime(),
+				preprocessor.getThreadCount(), hierarchy.nodeCount(), hierarchy.edgeCount());
+	}
+
+	/* -L: distances from -K landmarks to every cell */
+	if (landmarksFile) {
+		Landmarks landmarks;
+		if (!landmarks.build(preprocessor.walls(), landmarkCount) || !landmarks.write(landmarksFile))
+			return 1;
+		if (stats)
+			fprintf(stderr, "landmarks: %.3f ms, %d landmarks, %.1f MB each\n", landmarks.getBuildTime(),
+				landmarks.count(), landmarks.bytesPerLandmark() / 1e6);
+	}
 
 	return 0;
 }
@@ -1,9 +1,255 @@
-#include "JPSPlus.hpp"
+#include "Common.hpp"
+#include "GoalBounds.hpp"
+#include "Preprocessor.hpp"
+#include "Runtime.hpp"
+#include "SlicedSearch.hpp"
 
-int main() {
-	JPSPlus jpsPlus;
-	jpsPlus.read();
-	jpsPlus.run();
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 
+int main(int argc, char* argv[]) {
+	Runtime runtime;
+	const char* tableFile = nullptr;
+	bool verifyChecksum = false;
+	bool compact = false;
+	bool tiled = false;
+	bool preprocess = false;
+	bool batch = false;
+	bool printPath = false;
+	bool flow = false;
+	long sliceExpansions = 0;
+	const char* boundsFile = nullptr;
+	const char* hierarchyFile = nullptr;
+	const char* landmarksFile = nullptr;
+	const char* overlayFile = nullptr;
+	double suboptimality = 1;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "m:czypl:f:dqT:bPg:H:w:L:O:Fs:")) != -1) {
+		switch (opt) {
+			case 'm':
+				tableFile = optarg;
+				break;
+			case 'c':
+				verifyChecksum = true;
+				break;
+			case 'z':
+				compact = true;
+				break;
+			case 'y':
+				tiled = true;
+				break;
+			case 'p':
+				preprocess = true;
+				break;
+			case 'l':
+				if (!strcmp(optarg, "binary"))
+					runtime.setOpenList(Runtime::OPENLIST_BINARY);
+				else if (!strcmp(optarg, "indexed"))
+					runtime.setOpenList(Runtime::OPENLIST_INDEXED);
+				else if (!strcmp(optarg, "bucket"))
+					runtime.setOpenList(Runtime::OPENLIST_BUCKET);
+				else {
+					fprintf(stderr, "unknown open list %s\n", optarg);
+					return 1;
+				}
+				break;
+			case 'f': {
+				/* -f cardinal:diagonal, integer step costs */
+				int cardinal, diagonal;
+				if (sscanf(optarg, "%d:%d", &cardinal, &diagonal) != 2) {
+					fprintf(stderr, "bad fixed costs %s, expected cardinal:diagonal\n", optarg);
+					return 1;
+				}
+				if (!runtime.setFixedCosts(cardinal, diagonal))
+					return 1;
+				break;
+			}
+			case 'd':
+				runtime.setBidirectional(true);
+				break;
+			case 'b':
+				batch = true;
+				break;
+			case 'P':
+				printPath = true;
+				break;
+			case 'F':
+				flow = true;
+				break;
+			case 's':
+				sliceExpansions = std::max(1L, std::atol(optarg));
+				break;
+			case 'g':
+				boundsFile = optarg;
+				break;
+			case 'H':
+				hierarchyFile = optarg;
+				break;
+			case 'w':
+				suboptimality = std::strtod(optarg, nullptr);
+				break;
+			case 'L':
+				landmarksFile = optarg;
+				break;
+			case 'O':
+				overlayFile = optarg;
+				break;
+			case 'q':
+				runtime.setTrace(false);
+				break;
+			case 'T':
+				if (!runtime.setBinaryTrace(optarg))
+					return 1;
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-m table.bin [-c] | [-p] [-z]] [-y] [-l binary|indexed|bucket] [-f cardinal:diagonal] [-d] [-q | -T trace.bin] [-b] [-P] [-g bounds.bin] [-H hierarchy.bin [-w suboptimality]] [-L landmarks.bin] [-O blocked.txt] [-F | -s expansions]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	/* -p: stdin holds a map as read by preprocessing followed by the query,
+	 * and the search runs on the distances in memory */
+	Preprocessor preprocessor;
+	if (preprocess) {
+		if (!preprocessor.read())
+			return 1;
+		preprocessor.preprocess();
+		runtime.use(preprocessor, compact);
+		if (!runtime.readQuery())
+			return 1;
+	}
+	else if (tableFile) {
+		if (!runtime.load(tableFile, verifyChecksum) || !runtime.readQuery())
+			return 1;
+	}
+	else if (!runtime.read(compact))
+		return 1;
+
+	/* -y: distances and search state in 8x8 blocks */
+	if (tiled)
+		runtime.tile();
+
+	/* -g: goal bounds written by preprocessing -g for the same map */
+	GoalBounds bounds;
+	if (boundsFile && (!bounds.read(boundsFile) || !runtime.setGoalBounds(&bounds)))
+		return 1;
+
+	/* -L: landmarks written by preprocessing -L for the same map */
+	Landmarks landmarks;
+	if (landmarksFile && (!landmarks.read(landmarksFile) || !runtime.setLandmarks(&landmarks)))
+		return 1;
+
+	/* -H: hierarchy written by preprocessing -H for the same map; larger
+	 * bounds than -w 1 or inf let refined paths through, 1 searches as if
+	 * there was no hierarchy, since exact answers are not sped up */
+	Hierarchy hierarchy;
+	if (hierarchyFile && (!hierarchy.read(hierarchyFile) || !runtime.setHierarchy(&hierarchy, suboptimality)))
+		return 1;
+
+	/* -O: the cells listed as "col row" in the file are blocked on top of
+	 * the table, as if they were walls */
+	Overlay overlay;
+	if (overlayFile) {
+		Scanner cells;
+		if (!cells.open(overlayFile))
+			return 1;
+		overlay.resize(runtime.height(), runtime.width());
+		int col, row;
+		while (cells.readInt(col) && cells.readInt(row)) {
+			if (row < 0 || row >= runtime.height() || col < 0 || col >= runtime.width()) {
+				fprintf(stderr, "blocked cell (%d, %d) is outside the map\n", col, row);
+				return 1;
+			}
+			overlay.block(row, col);
+		}
+		if (cells.skipSpace() != EOF) {
+			fprintf(stderr, "%s: malformed blocked cell\n", overlayFile);
+			return 1;
+		}
+		runtime.setOverlay(&overlay);
+	}
+
+	/* -b: the table stays loaded and every further query on stdin is
+	 * answered in turn, until the end of the input */
+	auto start = std::chrono::steady_clock::now();
+	long queries = 0;
+	/* -F: the cost of the path from the start along a flow field toward
+	 * the goal, built again only when the goal changes */
+	FlowField field;
+	std::vector<FlowField::Cell> walked;
+	long fields = 0;
+	SlicedSearch sliced;
+	long slices = 0;
+	do {
+		++queries;
+		if (flow) {
+			int startRow, startCol, goalRow, goalCol;
+			runtime.getQuery(startRow, startCol, goalRow, goalCol);
+			if (goalRow != field.getGoalRow() || goalCol != field.getGoalCol()) {
+				runtime.buildFlowField(field);
+				++fields;
+			}
+			double cost;
+			if (field.walk(startRow, startCol, walked, cost))
+				printf("%.8f\n", cost);
+			else
+				printf("NO PATH\n");
+			/* an empty "PATH" without one, as after a search */
+			if (printPath) {
+				printf("PATH");
+				for (const FlowField::Cell& cell : walked)
+					printf(" %d %d", cell.col, cell.row);
+				printf("\n");
+			}
+			fflush(stdout);
+			continue;
+		}
+		/* -s: in slices of so many expansions, one way and untraced */
+		if (sliceExpansions) {
+			int startRow, startCol, goalRow, goalCol;
+			runtime.getQuery(startRow, startCol, goalRow, goalCol);
+			runtime.start(sliced, startRow, startCol, goalRow, goalCol);
+			do
+				++slices;
+			while (!runtime.resume(sliced, sliceExpansions));
+			if (sliced.pathFound())
+				printf("%.8f\n", sliced.getPathCost());
+			else
+				printf("NO PATH\n");
+			if (printPath) {
+				printf("PATH");
+				if (sliced.pathFound())
+					for (const SlicedSearch::Cell& cell : sliced.partialPath())
+						printf(" %d %d", cell.col, cell.row);
+				printf("\n");
+			}
+			fflush(stdout);
+			continue;
+		}
+		runtime.run();
+		/* -P: "PATH" and the jump points as "col row" after each query */
+		if (printPath) {
+			printf("PATH");
+			for (const Runtime::PathCell& cell : runtime.jumpPath())
+				printf(" %d %d", cell.col, cell.row);
+			printf("\n");
+			fflush(stdout);
+		}
+	} while (batch && runtime.readQuery());
+
+	if (batch) {
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		if (flow)
+			fprintf(stderr, "%ld queries, %.1f us/query, %ld flow fields\n", queries, us / queries, fields);
+		else if (sliceExpansions)
+			fprintf(stderr, "%ld queries, %.1f us/query, %.1f slices/query\n", queries, us / queries,
+				static_cast<double>(slices) / queries);
+		else
+			fprintf(stderr, "%ld queries, %.1f us/query\n", queries, us / queries);
+	}
 	return 0;
 }
@@ -0,0 +1,89 @@
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Latency samples in microseconds. Samples are kept whole rather than
+ * binned, a few million doubles per run at most, as a load generator takes.
+ */
+class LatencyLog {
+public:
+	void add(double us) { samples.push_back(us); }
+	void merge(const LatencyLog& o) { samples.insert(samples.end(), o.samples.begin(), o.samples.end()); }
+	void clear() { samples.clear(); }
+	std::size_t count() const { return samples.size(); }
+
+	/* the p-quantile (0 <= p <= 1), 0 without samples; reorders them */
+	double percentile(double p) {
+		if (samples.empty())
+			return 0;
+		std::size_t k = std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()));
+		std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+		return samples[k];
+	}
+
+private:
+	std::vector<double> samples;
+};
+
+/*
+ * Latencies in microseconds counted in buckets 1/32 wider than the one
+ * before, from 0.01 us to about three minutes: a fixed 6 KB however long a
+ * server runs, with quantiles at most 3.2% above the exact ones.
+ */
+class LatencyHistogram {
+public:
+	void add(double us) {
+		++counts[bucket(us)];
+		++total;
+	}
+	void merge(const LatencyHistogram& o) {
+		for (int i = 0; i < BUCKETS; ++i)
+			counts[i] += o.counts[i];
+		total += o.total;
+	}
+	void clear() {
+		counts.fill(0);
+		total = 0;
+	}
+	std::size_t count() const { return total; }
+
+	/* the p-quantile (0 <= p <= 1) as the upper end of its bucket, 0
+	 * without samples */
+	double percentile(double p) const {
+		if (!total)
+			return 0;
+		std::uint64_t k = std::min<std::uint64_t>(total - 1, static_cast<std::uint64_t>(p * total));
+		for (int i = 0; i < BUCKETS - 1; ++i) {
+			if (k < counts[i])
+				return upper(i);
+			k -= counts[i];
+		}
+		return upper(BUCKETS - 1);
+	}
+
+private:
+	static constexpr int BUCKETS = 768;
+	static constexpr double MIN_US = 0.01;
+	static constexpr double GROWTH = 1 + 1.0 / 32;
+
+	/* bucket i > 0 holds (upper(i - 1), upper(i)], 0 everything below */
+	static int bucket(double us) {
+		if (!(us > MIN_US))
+			return 0;
+		return std::min(BUCKETS - 1, static_cast<int>(std::ceil(std::log(us / MIN_US) / std::log(GROWTH))));
+	}
+	static double upper(int i) { return MIN_US * std::pow(GROWTH, i); }
+
+private:
+	std::array<std::uint64_t, BUCKETS> counts{};
+	std::uint64_t total = 0;
+};
+
+#endif /* LATENCY_HPP */
@@ -0,0 +1,158 @@
+#ifndef QUERYCACHE_HPP
+#define QUERYCACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * Bounded LRU cache of query results, split into shards with a lock each so
+ * that workers looking up different queries rarely wait on one another.
+ * Entries are tagged with the map version they were computed on; a map edit
+ * calls invalidate(), which moves to a new version and empties every shard,
+ * and a result computed on an older version is never stored.
+ */
+struct QueryKey {
+	int startRow, startCol;
+	int goalRow, goalCol;
+
+	bool operator==(const QueryKey& o) const {
+		return startRow == o.startRow && startCol == o.startCol && goalRow == o.goalRow && goalCol == o.goalCol;
+	}
+};
+
+struct QueryResult {
+	bool found;
+	double cost;
+	long expansions;
+};
+
+class QueryCache {
+public:
+	struct Counters {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+		std::uint64_t invalidations = 0;
+		std::size_t entries = 0;
+
+		double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0; }
+	};
+
+	/* `capacity` entries in all, rounded up to fill `shardCount` equal shards */
+	QueryCache(std::size_t capacity, int shardCount)
+		: shardCount(std::max(1, shardCount)), shards(new Shard[this->shardCount]) {
+		std::size_t perShard = std::max<std::size_t>(1, (capacity + this->shardCount - 1) / this->shardCount);
+		for (int s = 0; s < this->shardCount; ++s)
+			shards[s].capacity = perShard;
+	}
+
+	/* the current map version, to pass back to lookup() and insert() */
+	std::uint64_t version() const { return mapVersion.load(std::memory_order_acquire); }
+
+	bool lookup(const QueryKey& key, std::uint64_t version, QueryResult& result) {
+		Shard& shard = shardOf(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.index.find(key);
+		if (it == shard.index.end() || it->second->version != version) {
+			++shard.counters.misses;
+			return false;
+		}
+		/* most recently used first */
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+		result = it->second->result;
+		++shard.counters.hits;
+		return true;
+	}
+
+	/* dropped if the map changed since `version` was read */
+	void insert(const QueryKey& key, std::uint64_t version, const QueryResult& result) {
+		Shard& shard = shardOf(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (version != mapVersion.load(std::memory_order_acquire))
+			return;
+		auto it = shard.index.find(key);
+		if (it != shard.index.end()) {
+			it->second->version = version;
+			it->second->result = result;
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+			return;
+		}
+		if (shard.lru.size() >= shard.capacity) {
+			shard.index.erase(shard.lru.back().key);
+			shard.lru.pop_back();
+			++shard.counters.evictions;
+		}
+		shard.lru.push_front(Entry{key, version, result});
+		shard.index.emplace(key, shard.lru.begin());
+	}
+
+	/* the map changed: every entry so far is stale */
+	void invalidate() {
+		mapVersion.fetch_add(1, std::memory_order_acq_rel);
+		for (int s = 0; s < shardCount; ++s) {
+			std::lock_guard<std::mutex> lock(shards[s].mutex);
+			shards[s].index.clear();
+			shards[s].lru.clear();
+		}
+		invalidations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Counters counters() const {
+		Counters all;
+		for (int s = 0; s < shardCount; ++s) {
+			std::lock_guard<std::mutex> lock(shards[s].mutex);
+			all.hits += shards[s].counters.hits;
+			all.misses += shards[s].counters.misses;
+			all.evictions += shards[s].counters.evictions;
+			all.entries += shards[s].lru.size();
+		}
+		all.invalidations = invalidations.load(std::memory_order_relaxed);
+		return all;
+	}
+
+private:
+	struct Hash {
+		std::size_t operator()(const QueryKey& key) const {
+			std::uint64_t h = static_cast<std::uint32_t>(key.startRow);
+			h = h * 0x9e3779b97f4a7c15ull ^ static_cast<std::uint32_t>(key.startCol);
+			h = h * 0x9e3779b97f4a7c15ull ^ static_cast<std::uint32_t>(key.goalRow);
+			h = h * 0x9e3779b97f4a7c15ull ^ static_cast<std::uint32_t>(key.goalCol);
+			return static_cast<std::size_t>(h ^ h >> 29);
+		}
+	};
+
+	struct Entry {
+		QueryKey key;
+		std::uint64_t version;
+		QueryResult result;
+	};
+
+	/* a cache line each, so that the locks do not share one */
+	struct alignas(64) Shard {
+		mutable std::mutex mutex;
+		std::list<Entry> lru;
+		std::unordered_map<QueryKey, std::list<Entry>::iterator, Hash> index;
+		std::size_t capacity = 1;
+		Counters counters;
+	};
+
+	/* the high bits pick the shard, the map inside it uses all of them */
+	Shard& shardOf(const QueryKey& key) {
+		std::uint64_t h = Hash()(key) * 0x9e3779b97f4a7c15ull;
+		return shards[(h >> 32) % shardCount];
+	}
+
+private:
+	int shardCount;
+	std::unique_ptr<Shard[]> shards;
+	std::atomic<std::uint64_t> mapVersion{0};
+	std::atomic<std::uint64_t> invalidations{0};
+};
+
+#endif /* QUERYCACHE_HPP */
@@ -0,0 +1,85 @@
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * Unix-domain stream sockets shared by the server and the load generator.
+ * The protocol is line based: a client sends "startCol startRow goalCol
+ * goalRow" per query and gets back "cost expansions" or "NO PATH", in
+ * order; "STATS" returns the server's counters on one line. "BLOCK col
+ * row" and "UNBLOCK col row" make a cell a wall for the time being or open
+ * it again, answered with "OK". Any other line, a query short of four
+ * integers or with more, gets "ERROR"; blank lines get nothing.
+ */
+constexpr const char* DEFAULT_SOCKET = "/tmp/jpsplus.sock";
+
+inline bool socketAddress(const std::string& path, sockaddr_un& address) {
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) {
+		std::fprintf(stderr, "socket path too long: %s\n", path.c_str());
+		return false;
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	return true;
+}
+
+/* a listening socket at `path`, replacing a stale one, or -1 */
+inline int listenSocket(const std::string& path, int backlog) {
+	sockaddr_un address;
+	if (!socketAddress(path, address))
+		return -1;
+	int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		std::perror("socket");
+		return -1;
+	}
+	::unlink(path.c_str());
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+		::listen(fd, backlog) < 0) {
+		std::perror(path.c_str());
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+inline int connectSocket(const std::string& path) {
+	sockaddr_un address;
+	if (!socketAddress(path, address))
+		return -1;
+	int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		std::perror("socket");
+		return -1;
+	}
+	if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+		std::perror(path.c_str());
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+inline bool writeAll(int fd, const char* data, std::size_t bytes) {
+	while (bytes > 0) {
+		ssize_t n = ::send(fd, data, bytes, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		bytes -= n;
+	}
+	return true;
+}
+
+#endif /* SOCKET_HPP */
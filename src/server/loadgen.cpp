@@ -0,0 +1,129 @@
+#include "Latency.hpp"
+#include "Parallel.hpp"
+#include "Scanner.hpp"
+#include "Socket.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/*
+ * Load generator for the query server: `connections` clients, one thread
+ * and one connection each, send `count` queries apiece from a query file
+ * ("startCol startRow goalCol goalRow" per line, as for runtime -b), one
+ * at a time, and time every round trip. Prints the throughput and the
+ * p50/p99 latency seen by the clients, then the server's own STATS line.
+ */
+using Clock = std::chrono::steady_clock;
+
+struct Query {
+	int startCol, startRow;
+	int goalCol, goalRow;
+};
+
+/* one reply line, false if the server hung up */
+static bool readReply(Scanner& in, std::string& reply) {
+	reply.clear();
+	int c;
+	while ((c = in.get()) != EOF && c != '\n')
+		reply.push_back(static_cast<char>(c));
+	return c != EOF;
+}
+
+int main(int argc, char* argv[]) {
+	const char* usage = "usage: %s [-s socket] [-c connections] [-n queries] queries.txt\n";
+	std::string socketPath = DEFAULT_SOCKET;
+	int connections = 1;
+	long count = 1000;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:c:n:")) != -1) {
+		switch (opt) {
+			case 's':
+				socketPath = optarg;
+				break;
+			case 'c':
+				connections = std::max(1, std::atoi(optarg));
+				break;
+			case 'n':
+				count = std::max(1L, std::atol(optarg));
+				break;
+			default:
+				fprintf(stderr, usage, argv[0]);
+				return 1;
+		}
+	}
+	if (argc - optind != 1) {
+		fprintf(stderr, usage, argv[0]);
+		return 1;
+	}
+
+	Scanner queryFile;
+	std::vector<Query> queries;
+	if (!queryFile.open(argv[optind]))
+		return 1;
+	Query q;
+	while (queryFile.readInt(q.startCol) && queryFile.readInt(q.startRow) &&
+		queryFile.readInt(q.goalCol) && queryFile.readInt(q.goalRow))
+		queries.push_back(q);
+	if (queries.empty()) {
+		fprintf(stderr, "no queries in %s\n", argv[optind]);
+		return 1;
+	}
+
+	std::vector<LatencyLog> latency(connections);
+	std::vector<long> errors(connections);
+	auto start = Clock::now();
+	parallelRun(connections, [&](int t) {
+		int fd = connectSocket(socketPath);
+		if (fd < 0) {
+			errors[t] = count;
+			return;
+		}
+		Scanner in(fd);
+		std::string reply;
+		/* connections start at different offsets into the query list */
+		std::size_t next = static_cast<std::size_t>(t) * queries.size() / connections;
+		for (long i = 0; i < count; ++i) {
+			const Query& query = queries[next];
+			next = (next + 1) % queries.size();
+
+			char line[64];
+			int length = std::snprintf(line, sizeof(line), "%d %d %d %d\n",
+				query.startCol, query.startRow, query.goalCol, query.goalRow);
+			auto sent = Clock::now();
+			if (!writeAll(fd, line, length) || !readReply(in, reply)) {
+				errors[t] += count - i;
+				break;
+			}
+			latency[t].add(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+			if (reply == "ERROR")
+				++errors[t];
+		}
+		::close(fd);
+	});
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	LatencyLog all;
+	long failed = 0;
+	for (int t = 0; t < connections; ++t) {
+		all.merge(latency[t]);
+		failed += errors[t];
+	}
+	printf("client: %zu queries over %d connections in %.3f s, %.1f queries/s, p50 %.1f us, p99 %.1f us, %ld errors\n",
+		all.count(), connections, seconds, all.count() / seconds, all.percentile(0.5), all.percentile(0.99), failed);
+
+	int fd = connectSocket(socketPath);
+	if (fd >= 0) {
+		Scanner in(fd);
+		std::string reply;
+		if (writeAll(fd, "STATS\n", 6) && readReply(in, reply))
+			printf("server: %s\n", reply.c_str());
+		::close(fd);
+	}
+	return failed ? 1 : 0;
+}
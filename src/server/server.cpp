@@ -0,0 +1,516 @@
+#include "GoalBounds.hpp"
+#include "Latency.hpp"
+#include "Parallel.hpp"
+#include "Preprocessor.hpp"
+#include "QueryCache.hpp"
+#include "Runtime.hpp"
+#include "Scanner.hpp"
+#include "Socket.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+ * Long-running query server. One distance table, read from a table file or
+ * preprocessed from a map at startup, is shared read-only by a fixed pool
+ * of workers, each with a Runtime of its own for the search state. A poll
+ * thread watches every client connection and queues those with input; a
+ * worker takes one, answers the complete lines it has sent so far (one
+ * query or a pipelined batch, protocol in Socket.hpp) and hands it back, so
+ * any number of persistent clients share the workers. A connection is with
+ * one worker at a time and its replies keep their order. With -C, answers
+ * are kept in a QueryCache shared by the workers and repeated queries skip
+ * the search. "BLOCK" and "UNBLOCK" change the Overlay searched by all
+ * workers, which empties the cache. SIGINT or SIGTERM stops the server and
+ * prints its throughput and p50/p99 service time.
+ */
+using Clock = std::chrono::steady_clock;
+
+/* a client and the start of a line it has not finished sending */
+struct Connection {
+	int fd;
+	std::string input;
+};
+
+/* connections with input waiting for a free worker */
+class ConnectionQueue {
+public:
+	void push(Connection* connection) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			connections.push_back(connection);
+		}
+		ready.notify_one();
+	}
+
+	/* false once closed */
+	bool pop(Connection*& connection) {
+		std::unique_lock<std::mutex> lock(mutex);
+		ready.wait(lock, [this]() { return closed || !connections.empty(); });
+		if (closed)
+			return false;
+		connection = connections.front();
+		connections.pop_front();
+		return true;
+	}
+
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+			connections.clear();
+		}
+		ready.notify_all();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::deque<Connection*> connections;
+	bool closed = false;
+};
+
+struct Worker {
+	Runtime runtime;
+	Scanner in;
+	std::string out;
+
+	/* service times of the queries answered, guarded for STATS */
+	std::mutex statsMutex;
+	LatencyHistogram latency;
+};
+
+class Server {
+public:
+	/* cacheSize 0 runs every query; `overlay` is the one `table` searches */
+	Server(const Runtime& table, Overlay& overlay, int workerCount, std::size_t cacheSize);
+
+	bool listen(const std::string& path);
+	void run();
+	void stop();
+	std::string stats();
+
+private:
+	void poll();
+	void work(Worker& worker);
+	/* false once the connection is done with */
+	bool serve(Worker& worker, Connection& connection);
+	/* the reply to the one line in `in`, none to a blank line */
+	void request(Worker& worker, Scanner& in);
+	void answer(Worker& worker);
+	/* "BLOCK col row" or "UNBLOCK col row", after the command word */
+	bool edit(Scanner& in, bool block);
+	/* back to the poll thread for more input */
+	void rearm(Connection& connection);
+	void drop(Connection& connection);
+
+private:
+	std::string socketPath;
+	int listenFd = -1;
+	int pollFd = -1;
+	/* written to by stop() to end poll() */
+	int stopFd = -1;
+	Clock::time_point started;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+	ConnectionQueue queue;
+	std::unique_ptr<QueryCache> cache;
+	Overlay& overlay;
+
+	/* every open connection, shut down and closed on stop() */
+	std::mutex connectionsMutex;
+	std::map<int, std::unique_ptr<Connection>> connections;
+	bool stopping = false;
+};
+
+Server::Server(const Runtime& table, Overlay& overlay, int workerCount, std::size_t cacheSize)
+	: overlay(overlay) {
+	/* a few shards per worker keep lookups from queueing on one lock */
+	if (cacheSize)
+		cache.reset(new QueryCache(cacheSize, 4 * workerCount));
+	for (int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(new Worker);
+		workers.back()->runtime.share(table);
+		workers.back()->runtime.setTrace(false);
+	}
+}
+
+bool Server::listen(const std::string& path) {
+	socketPath = path;
+	listenFd = listenSocket(path, 128);
+	if (listenFd < 0)
+		return false;
+	pollFd = ::epoll_create1(EPOLL_CLOEXEC);
+	stopFd = ::eventfd(0, EFD_CLOEXEC);
+	epoll_event listenEvent{}, stopEvent{};
+	listenEvent.events = EPOLLIN;
+	listenEvent.data.fd = listenFd;
+	stopEvent.events = EPOLLIN;
+	stopEvent.data.fd = stopFd;
+	if (pollFd < 0 || stopFd < 0 || ::epoll_ctl(pollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) < 0 ||
+		::epoll_ctl(pollFd, EPOLL_CTL_ADD, stopFd, &stopEvent) < 0) {
+		std::perror("epoll");
+		return false;
+	}
+	return true;
+}
+
+void Server::run() {
+	started = Clock::now();
+	for (auto& worker : workers)
+		threads.emplace_back([this, &worker]() { work(*worker); });
+	threads.emplace_back([this]() { poll(); });
+}
+
+void Server::stop() {
+	std::uint64_t one = 1;
+	if (::write(stopFd, &one, sizeof(one)) < 0)
+		std::perror("eventfd");
+	queue.close();
+	/* workers blocked writing to a client that does not read get out */
+	{
+		std::lock_guard<std::mutex> lock(connectionsMutex);
+		stopping = true;
+		for (auto& connection : connections)
+			::shutdown(connection.first, SHUT_RDWR);
+	}
+	for (auto& thread : threads)
+		thread.join();
+	for (auto& connection : connections)
+		::close(connection.first);
+	connections.clear();
+	::close(stopFd);
+	::close(pollFd);
+	::close(listenFd);
+	::unlink(socketPath.c_str());
+}
+
+std::string Server::stats() {
+	LatencyHistogram all;
+	for (auto& worker : workers) {
+		std::lock_guard<std::mutex> lock(worker->statsMutex);
+		all.merge(worker->latency);
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+	char line[256];
+	std::snprintf(line, sizeof(line), "queries %zu qps %.1f p50 %.1f us p99 %.1f us workers %zu blocked %zu",
+		all.count(), all.count() / seconds, all.percentile(0.5), all.percentile(0.99), workers.size(),
+		overlay.blockedCount());
+	std::string result = line;
+	if (cache) {
+		QueryCache::Counters counters = cache->counters();
+		std::snprintf(line, sizeof(line), " cache hits %llu misses %llu hit rate %.1f%% entries %zu evictions %llu invalidations %llu",
+			static_cast<unsigned long long>(counters.hits), static_cast<unsigned long long>(counters.misses),
+			100 * counters.hitRate(), counters.entries, static_cast<unsigned long long>(counters.evictions),
+			static_cast<unsigned long long>(counters.invalidations));
+		result += line;
+	}
+	return result;
+}
+
+/* new clients are added to the poll set and connections with input go to
+ * the workers; each fires once until a worker rearms it. Connections are
+ * looked up, added and rearmed under connectionsMutex, which orders a
+ * worker's use of one before the next worker's */
+void Server::poll() {
+	epoll_event events[64];
+	for (;;) {
+		int n = ::epoll_wait(pollFd, events, 64, -1);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			return;
+		for (int i = 0; i < n; ++i) {
+			int fd = events[i].data.fd;
+			if (fd == stopFd)
+				return;
+			if (fd != listenFd) {
+				Connection* connection;
+				{
+					std::lock_guard<std::mutex> lock(connectionsMutex);
+					auto found = connections.find(fd);
+					if (found == connections.end())
+						continue;
+					connection = found->second.get();
+				}
+				queue.push(connection);
+				continue;
+			}
+			fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (fd < 0)
+				continue;
+			std::lock_guard<std::mutex> lock(connectionsMutex);
+			if (stopping) {
+				::close(fd);
+				continue;
+			}
+			connections[fd].reset(new Connection{ fd, std::string() });
+			epoll_event event{};
+			event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+			event.data.fd = fd;
+			if (::epoll_ctl(pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+				connections.erase(fd);
+				::close(fd);
+			}
+		}
+	}
+}
+
+void Server::work(Worker& worker) {
+	Connection* connection;
+	while (queue.pop(connection)) {
+		if (serve(worker, *connection))
+			rearm(*connection);
+		else
+			drop(*connection);
+	}
+}
+
+/* what the client has sent so far, up to the last full line (or all of it
+ * once it hung up), answered as one batch with one write */
+bool Server::serve(Worker& worker, Connection& connection) {
+	std::string& input = connection.input;
+	bool hungUp = false;
+	char block[1 << 16];
+	while (input.size() < Scanner::CAPACITY) {
+		ssize_t n = ::recv(connection.fd, block, sizeof(block), MSG_DONTWAIT);
+		if (n > 0)
+			input.append(block, n);
+		else if (n < 0 && errno == EINTR)
+			continue;
+		else {
+			hungUp = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+			break;
+		}
+	}
+	/* 0 without a line end; the last line needs none once the client hung up */
+	std::size_t lines = input.rfind('\n', Scanner::CAPACITY - 1) + 1;
+	if (hungUp && input.size() <= Scanner::CAPACITY)
+		lines = input.size();
+	/* no line end in a full buffer: not a line this server will read */
+	if (lines == 0 && input.size() >= Scanner::CAPACITY) {
+		writeAll(connection.fd, "ERROR\n", 6);
+		return false;
+	}
+
+	/* each request on a line of its own, so that a malformed one is
+	 * answered with a single ERROR and cannot take the next line along */
+	Scanner& in = worker.in;
+	std::string& out = worker.out;
+	out.clear();
+	for (std::size_t begin = 0; begin < lines;) {
+		std::size_t end = std::min(input.find('\n', begin), lines);
+		in.assign(input.data() + begin, end - begin);
+		request(worker, in);
+		begin = end + 1;
+	}
+	input.erase(0, lines);
+	in.attach(-1);
+	/* input left over after hanging up is taken on the next turn */
+	return writeAll(connection.fd, out.data(), out.size()) && (!hungUp || !input.empty());
+}
+
+void Server::request(Worker& worker, Scanner& in) {
+	std::string& out = worker.out;
+	int c = in.skipSpace();
+	if (c == EOF)
+		return;
+
+	if (std::isalpha(c)) {
+		std::string token;
+		in.readToken(token);
+		if (token == "STATS" && in.skipSpace() == EOF)
+			out += stats();
+		else if ((token == "BLOCK" || token == "UNBLOCK") && edit(in, token == "BLOCK"))
+			out += "OK";
+		else
+			out += "ERROR";
+		out += '\n';
+		return;
+	}
+
+	/* exactly four integers */
+	auto start = Clock::now();
+	if (!worker.runtime.readQuery(in) || in.skipSpace() != EOF) {
+		out += "ERROR\n";
+		return;
+	}
+	answer(worker);
+	double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	std::lock_guard<std::mutex> lock(worker.statsMutex);
+	worker.latency.add(us);
+}
+
+void Server::rearm(Connection& connection) {
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.fd = connection.fd;
+	{
+		std::lock_guard<std::mutex> lock(connectionsMutex);
+		if (::epoll_ctl(pollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0)
+			return;
+	}
+	drop(connection);
+}
+
+/* left to stop() once stopping, which closes what is left */
+void Server::drop(Connection& connection) {
+	std::lock_guard<std::mutex> lock(connectionsMutex);
+	if (stopping)
+		return;
+	int fd = connection.fd;
+	connections.erase(fd);
+	::close(fd);
+}
+
+/* the query read into worker.runtime, from the cache if it is there */
+void Server::answer(Worker& worker) {
+	Runtime& runtime = worker.runtime;
+	QueryKey key;
+	QueryResult result;
+	std::uint64_t version = 0;
+	runtime.getQuery(key.startRow, key.startCol, key.goalRow, key.goalCol);
+	if (cache)
+		version = cache->version();
+	if (!cache || !cache->lookup(key, version, result)) {
+		runtime.run();
+		result = QueryResult{runtime.pathFound(), runtime.getPathCost(), runtime.getExpansions()};
+		if (cache)
+			cache->insert(key, version, result);
+	}
+
+	char line[64];
+	if (result.found)
+		std::snprintf(line, sizeof(line), "%.8f %ld\n", result.cost, result.expansions);
+	else
+		std::snprintf(line, sizeof(line), "NO PATH\n");
+	worker.out += line;
+}
+
+/* the cache goes once the map has changed, so that no worker can store an
+ * answer computed before */
+bool Server::edit(Scanner& in, bool block) {
+	int col, row;
+	if (!in.readInt(col) || !in.readInt(row) || in.skipSpace() != EOF ||
+		row < 0 || row >= overlay.height() || col < 0 || col >= overlay.width())
+		return false;
+	bool changed = block ? overlay.block(row, col) : overlay.unblock(row, col);
+	if (changed && cache)
+		cache->invalidate();
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	const char* usage = "usage: %s [-t workers] [-s socket] [-z] [-y] [-g bounds.bin] [-L landmarks.bin] [-C cache entries] (-m table.bin | map)\n";
+	int workerCount = hardwareThreads();
+	std::string socketPath = DEFAULT_SOCKET;
+	const char* tableFile = nullptr;
+	bool compact = false;
+	bool tiled = false;
+	const char* boundsFile = nullptr;
+	const char* landmarksFile = nullptr;
+	std::size_t cacheSize = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:s:m:zyg:L:C:")) != -1) {
+		switch (opt) {
+			case 't':
+				workerCount = std::max(1, std::atoi(optarg));
+				break;
+			case 's':
+				socketPath = optarg;
+				break;
+			case 'm':
+				tableFile = optarg;
+				break;
+			case 'z':
+				compact = true;
+				break;
+			case 'y':
+				tiled = true;
+				break;
+			case 'g':
+				boundsFile = optarg;
+				break;
+			case 'L':
+				landmarksFile = optarg;
+				break;
+			case 'C':
+				cacheSize = std::strtoul(optarg, nullptr, 10);
+				break;
+			default:
+				fprintf(stderr, usage, argv[0]);
+				return 1;
+		}
+	}
+	if ((tableFile != nullptr) == (argc - optind == 1)) {
+		fprintf(stderr, usage, argv[0]);
+		return 1;
+	}
+
+	Runtime table;
+	Preprocessor preprocessor;
+	if (tableFile) {
+		if (!table.load(tableFile))
+			return 1;
+	}
+	else {
+		Scanner mapFile;
+		if (!mapFile.open(argv[optind]) || !preprocessor.read(mapFile))
+			return 1;
+		preprocessor.preprocess();
+		table.use(preprocessor, compact);
+	}
+	/* -y: a tiled copy of the table, shared by the workers as it is */
+	if (tiled)
+		table.tile();
+	GoalBounds bounds;
+	if (boundsFile && (!bounds.read(boundsFile) || !table.setGoalBounds(&bounds)))
+		return 1;
+	Landmarks landmarks;
+	if (landmarksFile && (!landmarks.read(landmarksFile) || !table.setLandmarks(&landmarks)))
+		return 1;
+
+	/* signals are taken by sigwait() below, not by any of the threads */
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+	std::signal(SIGPIPE, SIG_IGN);
+
+	/* nothing blocked until a client says so */
+	Overlay overlay(table.height(), table.width());
+	table.setOverlay(&overlay);
+
+	Server server(table, overlay, workerCount, cacheSize);
+	if (!server.listen(socketPath))
+		return 1;
+	server.run();
+	fprintf(stderr, "listening on %s with %d workers\n", socketPath.c_str(), workerCount);
+
+	int signal;
+	sigwait(&signals, &signal);
+	server.stop();
+	fprintf(stderr, "%s\n", server.stats().c_str());
+	return 0;
+}